@@ -0,0 +1,27 @@
+#ifndef _NATIVE_ARDUINO_H_
+#define _NATIVE_ARDUINO_H_
+
+// Just enough of Arduino.h for boards.h on the host builds (env:native,
+// env:bench); only the relay's config macros are used there, never the
+// board
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define OUTPUT     1
+#define LOW        0
+#define LED_GREEN  0
+
+class NativeSerial {
+public:
+    void begin(unsigned long) {}
+    operator bool() const { return false; }
+};
+
+extern NativeSerial Serial;
+
+unsigned long millis();
+void pinMode(uint32_t pin, uint32_t mode);
+void digitalWrite(uint32_t pin, uint32_t val);
+
+#endif // _NATIVE_ARDUINO_H_
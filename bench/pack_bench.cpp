@@ -0,0 +1,110 @@
+/*
+   Host benchmark for the payload packers (src/textpack.cpp, src/lwpack.cpp)
+
+   Packs a corpus of text lines (a file, one frame per line, or the
+   built-in samples) with each coder and reports the compression ratio
+   and the time per frame. With -x <coder>, prints that coder's packed
+   frames as hex, one per line, for checking against textpack.py /
+   lwpack.py.
+
+   g++ -O2 -std=gnu++11 -Iinclude -I.pio/libdeps/seeed_wio_tracker_L1/RadioLib/src \
+       bench/pack_bench.cpp src/textpack.cpp src/lwpack.cpp -o pack_bench
+   ./pack_bench [-x text|lw] [corpus.txt]
+*/
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include "textpack.h"
+#include "lwpack.h"
+
+static const char *samples[] = {
+    "Hello from TEMPEST",
+    "The quick brown fox jumps over the lazy dog",
+    "temperature 21.4 C, humidity 48 %, battery 3.91 V",
+    "meet at the north gate at 10:30, bring the spare antenna",
+    "ABC",
+    "SOS",
+    "this is a longer message that spans a few sentences. it is sent "
+    "over the air by a monitor that has no radio of its own, and the "
+    "relay forwards it to the mesh and to the network server.",
+};
+
+struct Coder {
+    const char *name;
+    size_t (*pack)(const uint8_t *in, size_t len, uint8_t *out, size_t outMax);
+    size_t frames, packedFrames, inBytes, outBytes;
+    double totalUs;
+};
+
+static Coder coders[] = {
+    { "text", textPack, 0, 0, 0, 0, 0 },
+    { "lw",   lwPack,   0, 0, 0, 0, 0 },
+};
+
+#define NUM_CODERS (sizeof(coders) / sizeof(coders[0]))
+#define RUNS 2000
+
+int main(int argc, char **argv)
+{
+    const char *hex = NULL;
+    FILE *corpus = NULL;
+    for (int a = 1; a < argc; a++) {
+        if (!strcmp(argv[a], "-x") && a + 1 < argc) hex = argv[++a];
+        else if (!(corpus = fopen(argv[a], "r"))) { perror(argv[a]); return 1; }
+    }
+
+    static char line[256];
+    static uint8_t out[256];
+    size_t nSamples = sizeof(samples) / sizeof(samples[0]);
+
+    for (size_t i = 0; ; i++) {
+        const char *text;
+        if (corpus) {
+            if (!fgets(line, sizeof(line), corpus)) break;
+            line[strcspn(line, "\n")] = 0;
+            text = line;
+        } else {
+            if (i == nSamples) break;
+            text = samples[i];
+        }
+        size_t len = strlen(text);
+        if (!len) continue;
+
+        if (!hex) printf("%3zu ->", len);
+        for (size_t c = 0; c < NUM_CODERS; c++) {
+            Coder &cd = coders[c];
+            if (hex && strcmp(hex, cd.name)) continue;
+
+            size_t packed = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < RUNS; r++)
+                packed = cd.pack((const uint8_t *)text, len, out, len - 1);
+            double us = std::chrono::duration<double, std::micro>(
+                            std::chrono::steady_clock::now() - start).count() / RUNS;
+
+            cd.frames++;
+            cd.inBytes += len;
+            cd.outBytes += packed ? packed : len;
+            cd.packedFrames += packed != 0;
+            cd.totalUs += us;
+
+            if (hex) {
+                for (size_t j = 0; j < packed; j++) printf("%02x", out[j]);
+                printf("\n");
+            } else {
+                printf("  %s %3zu %7.2f us", cd.name, packed ? packed : len, us);
+            }
+        }
+        if (!hex) printf("  %.30s\n", text);
+    }
+
+    for (size_t c = 0; c < NUM_CODERS && !hex; c++) {
+        const Coder &cd = coders[c];
+        if (!cd.frames) continue;
+        printf("%-4s %zu frames, %zu packed: %zu -> %zu bytes (%.1f %%), %.2f us/frame\n",
+               cd.name, cd.frames, cd.packedFrames, cd.inBytes, cd.outBytes,
+               100.0 * cd.outBytes / cd.inBytes, cd.totalUs / cd.frames);
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+   Host benchmark for the relay's protocol code (src/crypto.cpp,
+   src/frames.cpp) and for RadioLib's CRCs, bitwise and table-driven
+   (build with -DRADIOLIB_CRC_SLICE_BY_4=1 for the 4-table variant)
+
+   Times each routine, Google Benchmark style: time per call and
+   throughput. The known answers are checked by the Unity suites in
+   test/ (pio test -e native).
+
+   pio run -e bench && .pio/build/bench/program [filter]
+*/
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <RadioLib.h>
+#include "crypto.h"
+#include "frames.h"
+
+static const uint8_t meshKey[16] = {
+    0xd4, 0xf1, 0xbb, 0x3a, 0x20, 0x29, 0x07, 0x59,
+    0xf0, 0xbc, 0xff, 0xab, 0xcf, 0x4e, 0x69, 0x01,
+};
+
+// ── Benchmarks ──────────────────────────────────────────────────
+// Each runs for about BENCH_MS; the sink keeps results alive
+#define BENCH_MS  200
+
+static volatile uint8_t sink;
+static uint8_t buf[LW_B0_LEN + 255 + 13];
+
+struct Bench {
+    const char *name;
+    size_t bytes;                   // processed per call, for throughput
+    void (*fn)(size_t bytes);
+};
+
+static void bmEcb(size_t)
+{
+    aes128_ecb_encrypt(meshKey, buf, buf);
+}
+
+static void bmMeshCtr(size_t len)
+{
+    aes128ctr_encrypt(meshKey, 1, 0x27c82356, buf, len);
+}
+
+static void bmLoRaWANCtr(size_t len)
+{
+    aes128ctr_lorawan(appSKey, 0, 0x260B1234, 1, buf, len);
+}
+
+static void bmCmac(size_t len)
+{
+    aes_cmac(nwkSKey, buf, len, buf);
+}
+
+static void bmProtobuf(size_t len)
+{
+    static uint8_t payload[255];
+    encodeDataProtobuf(buf, 1, payload, len);
+}
+
+static void bmUplink(size_t len)
+{
+    static uint8_t payload[255];
+    uint16_t saved;
+    buildLoRaWANUplink(buf, payload, len, 0x260B1234, 1, false, 0, &saved);
+}
+
+// LR-FHSS payload CRC, the one the relay runs per uplink
+static void bmCrcBitwise(size_t len)
+{
+    RadioLibCRC crc;
+    crc.size = 16;
+    crc.poly = 0x755B;
+    crc.init = 0xFFFF;
+    crc.out = 0x0000;
+    sink = (uint8_t)crc.checksum(buf, len);
+}
+
+static void bmCrcTable(size_t len)
+{
+    sink = (uint8_t)RadioLibCRCTable<16, 0x755B, 0xFFFF, 0x0000>::checksum(buf, len);
+}
+
+static void bmCrc32Table(size_t len)
+{
+    sink = (uint8_t)RadioLibCRCTable<32, 0x04C11DB7, 0xFFFFFFFF, 0xFFFFFFFF, true, true>::checksum(buf, len);
+}
+
+static const Bench benches[] = {
+    { "aes128_ecb_encrypt",        16,  bmEcb },
+    { "aes128ctr_encrypt/64",      64,  bmMeshCtr },
+    { "aes128ctr_encrypt/237",     237, bmMeshCtr },
+    { "aes128ctr_lorawan/64",      64,  bmLoRaWANCtr },
+    { "aes_cmac/64",               64,  bmCmac },
+    { "encodeDataProtobuf/64",     64,  bmProtobuf },
+    { "buildLoRaWANUplink/18",     18,  bmUplink },
+    { "buildLoRaWANUplink/222",    222, bmUplink },
+    { "RadioLibCRC/16/64",         64,  bmCrcBitwise },
+    { "RadioLibCRCTable/16/64",    64,  bmCrcTable },
+    { "RadioLibCRCTable/16/255",   255, bmCrcTable },
+    { "RadioLibCRCTable/32/255",   255, bmCrc32Table },
+};
+
+int main(int argc, char **argv)
+{
+    const char *filter = argc > 1 ? argv[1] : NULL;
+
+    printf("%-32s %12s %12s %14s\n", "Benchmark", "Time", "Iterations", "Throughput");
+    for (const Bench &b : benches) {
+        if (filter && !strstr(b.name, filter)) continue;
+
+        // calibrate, then time a batch of about BENCH_MS
+        size_t iters = 1;
+        double ns;
+        for (;;) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iters; i++) b.fn(b.bytes);
+            ns = std::chrono::duration<double, std::nano>(
+                     std::chrono::steady_clock::now() - start).count();
+            if (ns >= BENCH_MS * 1e6) break;
+            iters *= ns < BENCH_MS * 1e5 ? 10 : 2;
+        }
+        sink = buf[0];
+        printf("%-32s %9.0f ns %12zu %9.2f MB/s\n", b.name, ns / iters, iters,
+               b.bytes * iters / ns * 1e3);
+    }
+    return 0;
+}
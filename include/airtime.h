@@ -0,0 +1,79 @@
+#ifndef _AIRTIME_H_
+#define _AIRTIME_H_
+
+#include <RadioLib.h>
+
+// ── Compile-time LoRa time-on-air tables ────────────────────────
+// The relay's radio profiles are fixed at build time, so the time on
+// air (µs) of every payload length is computed by the compiler instead
+// of by calculateTimeOnAir() for each frame. The arithmetic is the
+// same integer math as SX126x::calculateTimeOnAir() with an explicit
+// header and LDRO set the way RadioLib auto-configures it;
+// test/test_airtime checks every entry against it.
+
+template<uint8_t SF, uint16_t BwKhz, uint8_t CR, uint16_t Preamble, bool Crc>
+struct LoRaToa {
+    static constexpr uint32_t SymbolUs = ((uint32_t)10000 << SF) / ((uint32_t)BwKhz * 10);
+
+    // RadioLib enables LDRO for symbols of 16 ms and longer
+    static constexpr bool Ldro = ((uint32_t)1 << SF) >= 16 * (uint32_t)BwKhz;
+
+    // time on air of a `len` byte payload
+    static uint32_t us(size_t len)
+    {
+        return len < Entries ? table.t[len] : calc(len);
+    }
+
+    static constexpr uint32_t calc(size_t len)
+    {
+        return SymbolUs * ((Preamble + 8) * 4 + (SF <= 6 ? 25 : 17) +
+                           codedSymbols(bits(len)) * CR * 4) / 4;
+    }
+
+private:
+    static constexpr size_t Entries = RADIOLIB_SX126X_MAX_PACKET_LENGTH + 1;
+
+    static constexpr uint32_t Divisor = 4 * (SF - (Ldro ? 2 : 0));
+
+    struct Table {
+        uint32_t t[Entries];
+    };
+
+    // payload + CRC + explicit header bits, less what the first
+    // symbols carry (clamped at 0 like the runtime version)
+    static constexpr int32_t bits(size_t len)
+    {
+        return (int32_t)(8 * len) + (Crc ? 16 : 0) - 4 * SF +
+               (SF <= 6 ? 0 : 8) + 20;
+    }
+
+    static constexpr uint32_t codedSymbols(int32_t b)
+    {
+        return b <= 0 ? 0 : ((uint32_t)b + Divisor - 1) / Divisor;
+    }
+
+    template<size_t... I>
+    static constexpr Table generate(RadioLibIndexSeq<I...>)
+    {
+        return Table{{ calc(I)... }};
+    }
+
+    static constexpr Table table = generate(typename RadioLibMakeIndexSeq<Entries>::type());
+};
+
+template<uint8_t SF, uint16_t BwKhz, uint8_t CR, uint16_t Preamble, bool Crc>
+constexpr typename LoRaToa<SF, BwKhz, CR, Preamble, Crc>::Table LoRaToa<SF, BwKhz, CR, Preamble, Crc>::table;
+
+// configTempest(): BW 500, SF 7, CR 4/5, 8 symbol preamble, CRC on
+typedef LoRaToa<7, 500, 5, 8, true>    ToaTempest;
+
+// configLoRaWAN(): BW 125, SF 7, CR 4/5, 8 symbol preamble, CRC on
+typedef LoRaToa<7, 125, 5, 8, true>    ToaLoRaWAN;
+
+// configLoRaWAN() at US915 DR4: BW 500, SF 8, otherwise as above
+typedef LoRaToa<8, 500, 5, 8, true>    ToaLoRaWANDr4;
+
+// Meshtastic modem presets instantiate their own tables, see
+// meshPresets[] in main.cpp
+
+#endif // _AIRTIME_H_
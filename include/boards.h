@@ -10,15 +10,37 @@
 #define RADIO_BUSY_PIN  D3   // P1.10
 #define RADIO_RXEN_PIN  D5   // P1.08
 
+// RX timestamps: DIO1 → GPIOTE → PPI → capture of a 1 MHz TIMER.
+// Neither may be used by the core or the SoftDevice
+#define RX_STAMP_TIMER   NRF_TIMER4
+#define RX_STAMP_PPI_CH  8
+
 // TCXO reference voltage on DIO3
 #define RADIO_TCXO_VOLTAGE 1.8
 
 // LoRa frequency (MHz)
 #define LoRa_frequency 915.0
 
+// Track the TEMPEST emitter's carrier offset: RX is retuned once the
+// filtered offset of good packets moves TEMPEST_AFC_STEP_HZ away from
+// the current tuning, at most TEMPEST_AFC_MAX_HZ off LoRa_frequency
+#define TEMPEST_AFC          1
+#define TEMPEST_AFC_STEP_HZ  2000
+#define TEMPEST_AFC_MAX_HZ   60000
+
 // Node ID used in outgoing Meshtastic headers
 #define DEVICE_NODE_ID 0x27c82356
 
+// RX boosted gain (a few dB of sensitivity for ~2 mA): switched on
+// while the TEMPEST SNR margin over the SF7 floor averages below
+// RX_BOOST_MARGIN_DB or CRC errors near that floor pile up, and only
+// while the noise floor sampled between packets is under
+// RX_BOOST_NOISE_DBM; above it the noise is external and more gain
+// buys nothing. 0 = never boosted, 1 = adaptive, 2 = always boosted
+#define RX_BOOST_GAIN        1
+#define RX_BOOST_MARGIN_DB   6
+#define RX_BOOST_NOISE_DBM   (-100)
+
 // LoRaWAN ABP credentials (replace with your network values)
 #define LORAWAN_DEV_ADDR   0x00000000
 #define LORAWAN_NWK_SKEY   { 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, \
@@ -26,6 +48,121 @@
 #define LORAWAN_APP_SKEY   { 0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, \
                              0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00 }
 
+// LoRaWAN uplink data rate (US915): 3 = LoRa, per frame the shorter of
+// SF7/BW125 (DR3) and SF8/BW500 (DR4) the link margin allows, 4 = always
+// DR4, 5 / 6 = LR-FHSS 1523 kHz, CR 1/3 / 2/3 (needs an LR-FHSS gateway)
+#define LORAWAN_UPLINK_DR  3
+
+// DR4 is only used while the last LinkCheckAns margin, as seen at DR3,
+// leaves this much headroom above the DR4 demodulation floor (dB).
+// A LinkCheckReq rides along every LORAWAN_LINKCHECK_EVERY uplinks
+// (0 = never, which pins LoRa uplinks to DR3)
+#define LORAWAN_DR4_MARGIN_FLOOR_DB  6
+#define LORAWAN_LINKCHECK_EVERY      16
+
+// Send LoRaWAN payloads packed (lwpack.h) on their own FPort when that
+// is shorter; the application server needs lwpack.py's decoder
+#define LORAWAN_PACK_PAYLOAD  0
+#define LORAWAN_PACK_FPORT    2
+
+// Relay rules (rules.h), checked in order on every received frame;
+// the first match picks its uplinks: ROUTE_LORAWAN, ROUTE_MESH,
+// ROUTE_BOTH or ROUTE_DROP. Frames matching no rule take
+// RELAY_DEFAULT_ROUTE. A rule matches a payload starting with its
+// prefix (up to 4 bytes, "" = any), length in [min, max] and RSSI /
+// SNR at least the given dBm / dB. Up to 8 rules, e.g.
+//   RELAY_RULE("T:", 3, 255, RULE_ANY_RSSI, RULE_ANY_SNR, ROUTE_LORAWAN)
+//   RELAY_RULE("",   1, 255, -120, RULE_ANY_SNR, ROUTE_BOTH)
+//   RELAY_RULE("",   0, 255, RULE_ANY_RSSI, RULE_ANY_SNR, ROUTE_DROP)
+#define RELAY_RULES  { \
+    RELAY_RULE("", 0, 255, RULE_ANY_RSSI, RULE_ANY_SNR, ROUTE_BOTH), \
+}
+#define RELAY_DEFAULT_ROUTE  ROUTE_BOTH
+
+// Append each frame's hardware RX timestamp (µs, 4 bytes LE) to the
+// LoRaWAN FRMPayload, after the text; FPort then has
+// LORAWAN_STAMP_FPORT_BIT set. Differences between stamps are the
+// TEMPEST frames' spacing, free of relay latency
+#define LORAWAN_RX_STAMP         0
+#define LORAWAN_STAMP_FPORT_BIT  0x10
+
+// Airtime budgets per uplink: ms of TX per hour, and the largest burst
+// (token bucket depth). Frames over budget wait and are merged with
+// the ones queued behind them
+#define LORAWAN_AIRTIME_MS_PER_HOUR  36000   // 1 %
+#define LORAWAN_AIRTIME_BURST_MS     2000
+#define MESH_AIRTIME_MS_PER_HOUR     360000  // 10 %, Meshtastic's own TX limit
+#define MESH_AIRTIME_BURST_MS        10000
+
+// Meshtastic modem presets the relay may transmit on, most robust
+// first (MESH_LONG_FAST, MESH_MEDIUM_FAST, ... see meshPresets[] in
+// main.cpp); receiving nodes must be on the matching preset. Each frame
+// takes the first preset whose time on air fits MESH_TOA_TARGET_MS,
+// shrunk by that channel's measured busy ratio, else the last one.
+// A single entry pins the preset
+#define MESH_PRESETS        { MESH_LONG_FAST, MESH_MEDIUM_FAST, MESH_SHORT_FAST }
+#define MESH_TOA_TARGET_MS  500
+#define MESH_BUSY_RSSI_DBM  (-100)  // instantaneous RSSI counted as busy
+
+// Send Meshtastic text packed (textpack.h, PortNum PRIVATE_APP) when
+// that is shorter. Stock Meshtastic clients can't read it; listen.py can
+#define MESH_PACK_TEXT      0
+
+// Listen before talk: each uplink waits a random contention window of
+// 0..2^CW - 1 backoff slots, then runs a CAD with the target profile's
+// SF / BW and only transmits if it found no preamble. CW starts between
+// LBT_CW_MIN and LBT_CW_MAX by the TEMPEST frame's SNR (weaker goes
+// first, so the relay farthest from the source wins, as in Meshtastic's
+// rebroadcast timing) and grows by one per busy CAD. The frame is
+// dropped after LBT_MAX_TRIES busy CADs. Not used with LR-FHSS
+#define LORAWAN_LBT    1
+#define MESH_LBT       1
+#define LBT_CW_MIN     1
+#define LBT_CW_MAX     5
+#define LBT_MAX_TRIES  4
+
+// Spectrum survey instead of relaying: sweeps SURVEY_START_KHZ ..
+// SURVEY_STOP_KHZ in SURVEY_STEP_KHZ steps, reading the instantaneous
+// RSSI in a SURVEY_RBW_KHZ LoRa bandwidth, and streams max-hold and
+// average spectra over serial every SURVEY_REPORT_MS while drawing
+// them on the OLED. 0 = relay
+#define SURVEY_MODE       0
+#define SURVEY_START_KHZ  902000
+#define SURVEY_STOP_KHZ   928000
+#define SURVEY_STEP_KHZ   125
+#define SURVEY_RBW_KHZ    125
+#define SURVEY_SETTLE_US  300     // RX time per step before the RSSI read
+#define SURVEY_REPORT_MS  500
+
+// Packet sniffer instead of relaying: every TEMPEST frame received
+// with a good CRC goes to USB as a LoRaTap record (sniff.py turns the
+// stream into pcap for Wireshark) and nothing is transmitted. The
+// text log is muted once the tasks start so the link carries records
+// only. 0 = relay
+#define SNIFFER_MODE      0
+
+// Idle power. Between packets every task blocks and the core's
+// tickless idle sleeps in System ON until an interrupt; the OLED is
+// also switched off DISPLAY_SLEEP_MS after the last status change
+// (0 = always on), and USB USB_IDLE_OFF_MS after VBUS came up with no
+// host enumerating it, as from a charger, until the next plug-in
+// (0 = never). The POWER_* currents (µA) only feed the charge
+// estimate reported with the task stats
+#define DISPLAY_SLEEP_MS      30000
+#define USB_IDLE_OFF_MS       10000
+#define POWER_MCU_ACTIVE_UA   3300      // nRF52840 running from flash, DC/DC
+#define POWER_MCU_SLEEP_UA    3         // System ON, RTC wake-up
+#define POWER_RX_UA           4600      // SX1262 RX, power saving gain
+#define POWER_RX_BOOST_UA     5300      // SX1262 RX, boosted gain
+#define POWER_TX_UA           118000    // SX1262 at +22 dBm
+#define POWER_OLED_UA         10000     // SSD1306 on, text screen
+
+// Run the AES / CMAC code and the S-box from RAM, see ramfunc.h.
+// RAMFUNC_BENCH prints their cycle counts at boot; build with FAST_RAM
+// 0 and 1 to compare flash against RAM
+#define FAST_RAM        1
+#define RAMFUNC_BENCH   0
+
 // LED pin
 #define BOARD_LED LED_GREEN
 
@@ -0,0 +1,31 @@
+#ifndef _CRYPTO_H_
+#define _CRYPTO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ramfunc.h"
+
+// ── AES-128 and its modes ───────────────────────────────────────
+// Software AES-128 (encrypt direction only), the CTR modes of the two
+// uplinks and AES-CMAC. All of it runs from RAM on the target, see
+// ramfunc.h; the declarations carry RAMFUNC so callers in flash reach
+// it with a long call.
+
+// One 16-byte block, `in` and `out` may be the same buffer
+RAMFUNC void aes128_ecb_encrypt(const uint8_t key[16], const uint8_t in[16], uint8_t out[16]);
+
+// Meshtastic CTR, in place. Nonce [packetId:8 LE][fromNode:4 LE][0:4],
+// counter incremented big-endian over the whole block
+RAMFUNC void aes128ctr_encrypt(const uint8_t key[16], uint32_t packetId,
+                               uint32_t fromNode, uint8_t *data, size_t len);
+
+// LoRaWAN FRMPayload encryption, in place (dir 0 = up, 1 = down)
+RAMFUNC void aes128ctr_lorawan(const uint8_t key[16], uint8_t dir,
+                               uint32_t devAddr, uint32_t fCnt,
+                               uint8_t *data, size_t len);
+
+// AES-CMAC (RFC 4493)
+RAMFUNC void aes_cmac(const uint8_t key[16], const uint8_t *msg, size_t len,
+                      uint8_t mac[16]);
+
+#endif // _CRYPTO_H_
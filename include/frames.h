@@ -0,0 +1,36 @@
+#ifndef _FRAMES_H_
+#define _FRAMES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "boards.h"
+
+// ── Uplink framing ──────────────────────────────────────────────
+// The Meshtastic Data protobuf and the LoRaWAN uplink / MIC, kept
+// apart from the radio code so the host build (env:native) can run
+// them too.
+
+#define LW_B0_LEN         16                    // MIC B0 block headroom
+#define LW_STAMP_LEN      (LORAWAN_RX_STAMP ? 4 : 0)
+
+extern const uint8_t nwkSKey[16];
+extern const uint8_t appSKey[16];
+
+// Data protobuf: portnum (field 1), payload (field 2).
+// Returns the encoded length
+size_t encodeDataProtobuf(uint8_t *out, uint32_t portnum,
+                          const uint8_t *payload, size_t payloadLen);
+
+// MIC of the msgLen byte message at buf + LW_B0_LEN; the B0 block is
+// assembled in the headroom in front of it
+void lorawanMic(uint8_t *buf, size_t msgLen, uint8_t dir,
+                uint32_t devAddr, uint32_t fCnt, uint8_t mic[4]);
+
+// Unconfirmed Data Up frame at buf + LW_B0_LEN, see frames.cpp.
+// Returns the frame length (excluding the headroom)
+size_t buildLoRaWANUplink(uint8_t *buf, const uint8_t *payload,
+                          size_t payloadLen, uint32_t devAddr,
+                          uint16_t fCnt, bool linkCheck,
+                          uint32_t rxStampUs, uint16_t *packSaved);
+
+#endif // _FRAMES_H_
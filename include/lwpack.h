@@ -0,0 +1,26 @@
+#ifndef _LWPACK_H_
+#define _LWPACK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ── LoRaWAN payload packing ─────────────────────────────────────
+// LZ77 over a window that starts out holding a static dictionary
+// of phrases common in TEMPEST text, so even the first bytes of a
+// short frame can be sent as back-references. Literals use the
+// textpack.h Huffman codes. Tokens, MSB first:
+//   1 <textpack code>                     literal
+//   0 <distance - 1 : 9> <length - 3 : 4> copy 3..18 bytes
+// Padding is 1 bits, an incomplete literal. The window is the
+// dictionary in flash plus the input itself, so packing needs no
+// RAM besides the output. lwpack.py holds the decoder.
+
+// Longest input; the dictionary and the input share the 512-byte window
+#define LWPACK_MAX_LEN  255
+
+// Pack `len` bytes of `in` into `out`. Gives up as soon as the result
+// would exceed `outMax` bytes; pass len - 1 to only accept a gain.
+// Returns the packed length, or 0 if it did not fit
+size_t lwPack(const uint8_t *in, size_t len, uint8_t *out, size_t outMax);
+
+#endif // _LWPACK_H_
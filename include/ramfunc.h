@@ -0,0 +1,28 @@
+#ifndef _RAMFUNC_H_
+#define _RAMFUNC_H_
+
+#include "boards.h"
+
+// ── Code and tables in RAM ──────────────────────────────────────
+// RAMFUNC places a function in .ramfunc, FASTDATA a constant table in
+// .fastdata. The linker script loads both behind the .data image and
+// ramfuncCopy() moves them to RAM before any constructor runs, so the
+// crypto hot paths execute and look up their tables without flash
+// wait states. RAM code is out of BL range of flash, hence long_call;
+// noinline keeps flash callers from pulling a copy back into flash.
+// Anything RAM code calls runs from flash, libc's memcpy / memset
+// too, so its helpers are RAMINLINE and its copies plain loops that
+// GCC is told not to turn back into library calls.
+// FAST_RAM 0 leaves everything in flash, for comparing cycle counts;
+// host builds ignore the macros.
+#if FAST_RAM && defined(__arm__)
+#define RAMFUNC   __attribute__((section(".ramfunc"), noinline, long_call, \
+                                 optimize("no-tree-loop-distribute-patterns")))
+#define FASTDATA  __attribute__((section(".fastdata")))
+#else
+#define RAMFUNC
+#define FASTDATA
+#endif
+#define RAMINLINE inline __attribute__((always_inline))
+
+#endif // _RAMFUNC_H_
@@ -0,0 +1,124 @@
+#ifndef _RULES_H_
+#define _RULES_H_
+
+#include <RadioLib.h>
+#include <math.h>
+#include "boards.h"
+
+// ── Compile-time relay rules ────────────────────────────────────
+// The rules in RELAY_RULES (boards.h) are fixed at build time, so the
+// compiler turns them into bit masks, one bit per rule: for each
+// value of each frame property, the rules that value satisfies. A
+// frame is then routed by ANDing one mask per property (payload
+// length, RSSI, SNR and the first RULE_PREFIX_MAX payload bytes) and
+// taking the lowest set bit, the first matching rule: seven table
+// lookups per frame however many rules there are.
+
+// Destinations, a bit per TXQ_* output queue
+#define ROUTE_DROP     0
+#define ROUTE_LORAWAN  1
+#define ROUTE_MESH     2
+#define ROUTE_BOTH     (ROUTE_LORAWAN | ROUTE_MESH)
+
+#define RULE_PREFIX_MAX  4
+#define RULE_ANY_RSSI    (-160)     // dBm, lowest the SX1262 reports
+#define RULE_ANY_SNR     (-32)      // dB
+
+struct RelayRule {
+    char    prefix[RULE_PREFIX_MAX + 1];
+    uint8_t prefixLen;
+    uint8_t minLen;
+    uint8_t maxLen;
+    int16_t minRssi;                // dBm
+    int8_t  minSnr;                 // dB
+    uint8_t route;                  // ROUTE_*
+};
+
+// Payload prefix (at most RULE_PREFIX_MAX bytes, "" = any), length
+// range, minimum RSSI / SNR and the destinations of matching frames
+#define RELAY_RULE(prefix, minLen, maxLen, minRssi, minSnr, route) \
+    { prefix, sizeof(prefix) - 1, minLen, maxLen, minRssi, minSnr, route }
+
+static constexpr RelayRule relayRules[] = RELAY_RULES;
+#define RELAY_RULE_COUNT  (sizeof(relayRules) / sizeof(relayRules[0]))
+static_assert(RELAY_RULE_COUNT <= 8, "rule masks are 8 bits wide");
+
+#define RULE_RSSI_STEPS  (1 - RULE_ANY_RSSI)    // -RSSI 0..160
+#define RULE_SNR_STEPS   64                     // SNR + 32, -32..31
+
+struct RuleTables {
+    uint8_t prefix[RULE_PREFIX_MAX * 256];      // [pos * 256 + byte]
+    uint8_t len[256];
+    uint8_t rssi[RULE_RSSI_STEPS];
+    uint8_t snr[RULE_SNR_STEPS];
+};
+
+// Rules from `r` on that accept a property value, as a bit mask
+static constexpr uint8_t ruleMaskPrefix(size_t pos, uint8_t b, size_t r = 0)
+{
+    return r == RELAY_RULE_COUNT ? 0 :
+           ((relayRules[r].prefixLen <= pos || (uint8_t)relayRules[r].prefix[pos] == b) ? 1 << r : 0) |
+           ruleMaskPrefix(pos, b, r + 1);
+}
+
+static constexpr uint8_t ruleMaskLen(size_t len, size_t r = 0)
+{
+    // a frame shorter than the prefix can't match it
+    return r == RELAY_RULE_COUNT ? 0 :
+           ((len >= relayRules[r].minLen && len <= relayRules[r].maxLen &&
+             len >= relayRules[r].prefixLen) ? 1 << r : 0) |
+           ruleMaskLen(len, r + 1);
+}
+
+static constexpr uint8_t ruleMaskRssi(int32_t rssi, size_t r = 0)
+{
+    return r == RELAY_RULE_COUNT ? 0 :
+           (rssi >= relayRules[r].minRssi ? 1 << r : 0) | ruleMaskRssi(rssi, r + 1);
+}
+
+static constexpr uint8_t ruleMaskSnr(int32_t snr, size_t r = 0)
+{
+    return r == RELAY_RULE_COUNT ? 0 :
+           (snr >= relayRules[r].minSnr ? 1 << r : 0) | ruleMaskSnr(snr, r + 1);
+}
+
+template<size_t... P, size_t... B, size_t... R, size_t... S>
+static constexpr RuleTables ruleGenerate(RadioLibIndexSeq<P...>, RadioLibIndexSeq<B...>,
+                                         RadioLibIndexSeq<R...>, RadioLibIndexSeq<S...>)
+{
+    return RuleTables{
+        { ruleMaskPrefix(P / 256, P % 256)... },
+        { ruleMaskLen(B)... },
+        { ruleMaskRssi(-(int32_t)R)... },
+        { ruleMaskSnr((int32_t)S + RULE_ANY_SNR)... },
+    };
+}
+
+static constexpr RuleTables ruleTables = ruleGenerate(
+    RadioLibMakeIndexSeq<RULE_PREFIX_MAX * 256>::type(), RadioLibMakeIndexSeq<256>::type(),
+    RadioLibMakeIndexSeq<RULE_RSSI_STEPS>::type(), RadioLibMakeIndexSeq<RULE_SNR_STEPS>::type());
+
+// Route of a received frame. `in` must be readable for RULE_PREFIX_MAX
+// bytes past `len`; bytes past the end never decide a match. The
+// matching rule's index, or -1 for RELAY_DEFAULT_ROUTE, goes to `rule`
+static inline uint8_t relayRoute(const uint8_t *in, size_t len, float rssi, float snr, int8_t *rule)
+{
+    // whole dB, rounded down so a threshold is never met early
+    int32_t r = -(int32_t)floorf(rssi);
+    int32_t s = (int32_t)floorf(snr) - RULE_ANY_SNR;
+    r = r < 0 ? 0 : (r >= RULE_RSSI_STEPS ? RULE_RSSI_STEPS - 1 : r);
+    s = s < 0 ? 0 : (s >= RULE_SNR_STEPS ? RULE_SNR_STEPS - 1 : s);
+
+    uint8_t m = ruleTables.len[len > 255 ? 255 : len] & ruleTables.rssi[r] & ruleTables.snr[s];
+    for (size_t pos = 0; pos < RULE_PREFIX_MAX; pos++)
+        m &= ruleTables.prefix[pos * 256 + in[pos]];
+
+    if (!m) {
+        *rule = -1;
+        return RELAY_DEFAULT_ROUTE;
+    }
+    *rule = (int8_t)__builtin_ctz(m);
+    return relayRules[*rule].route;
+}
+
+#endif // _RULES_H_
@@ -0,0 +1,31 @@
+#ifndef _TEXTPACK_H_
+#define _TEXTPACK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ── Static-Huffman text packing ─────────────────────────────────
+// TEMPEST payloads are mostly short ASCII text, so each byte is coded
+// with a fixed canonical Huffman code built from English character
+// frequencies: 3 bits for a space, 4-6 for common lower-case letters.
+// Bytes outside printable ASCII and '\n' are escaped and sent raw.
+// The last byte is padded with 1 bits, which never complete a code,
+// so no length field is needed. textpack.py holds the decoder.
+//
+// Packing runs in place over the caller's buffers: no heap, no
+// tables built at run time, a 32-bit bit accumulator on the stack.
+
+// Marks a Meshtastic Data payload as packed text (PortNum.PRIVATE_APP)
+#define TEXTPACK_PORTNUM  256
+
+// Pack `len` bytes of `in` into `out`. Gives up as soon as the result
+// would exceed `outMax` bytes; pass len - 1 to only accept a gain.
+// Returns the packed length, or 0 if it did not fit
+size_t textPack(const uint8_t *in, size_t len, uint8_t *out, size_t outMax);
+
+// Code of a single byte, for coders that mix it with other tokens:
+// the code (raw byte appended if escaped) is returned in `code`,
+// right-aligned. Returns its length in bits, at most 21
+uint8_t textPackCode(uint8_t b, uint32_t *code);
+
+#endif // _TEXTPACK_H_
@@ -93,6 +93,20 @@
   #define RADIOLIB_INTERRUPT_TIMING  (0)
 #endif
 
+/*
+ * CRC implementation selection for fixed CRC configurations (RadioLibCRCTable).
+ * By default, one 256-entry lookup table generated at compile time is used per configuration (1 kB of flash each).
+ * RADIOLIB_CRC_SLICE_BY_4 processes 4 bytes per step using 4 tables instead (4 kB of flash per configuration).
+ * RADIOLIB_CRC_BITWISE disables the lookup tables and processes the input bit by bit, for size-optimized builds.
+ */
+#if !defined(RADIOLIB_CRC_BITWISE)
+  #define RADIOLIB_CRC_BITWISE (0)
+#endif
+
+#if !defined(RADIOLIB_CRC_SLICE_BY_4)
+  #define RADIOLIB_CRC_SLICE_BY_4 (0)
+#endif
+
 /*
  * Enable static-only memory management: no dynamic allocation will be performed.
  * Warning: Large static arrays will be created in some methods. It is not advised to send large packets in this mode.
@@ -249,6 +263,9 @@
   // Adafruit nRF52 boards
   #define RADIOLIB_PLATFORM                           "Adafruit nRF52"
 
+  // SPIM EasyDMA can move the whole frame in one transfer
+  #define RADIOLIB_ARDUINOHAL_SPI_BLOCK_TRANSFER
+
 #elif defined(ARDUINO_ARC32_TOOLS)
   // Intel Curie
   #define RADIOLIB_PLATFORM                           "Intel Curie"
@@ -101,9 +101,13 @@ void inline ArduinoHal::spiBeginTransaction() {
 }
 
 void ArduinoHal::spiTransfer(uint8_t* out, size_t len, uint8_t* in) {
+  #if defined(RADIOLIB_ARDUINOHAL_SPI_BLOCK_TRANSFER)
+  spi->transfer(out, in, len);
+  #else
   for(size_t i = 0; i < len; i++) {
     in[i] = spi->transfer(out[i]);
   }
+  #endif
 }
 
 void inline ArduinoHal::spiEndTransaction() {
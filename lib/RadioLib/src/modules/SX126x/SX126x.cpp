@@ -178,6 +178,9 @@ int16_t SX126x::setLrFhssConfig(uint8_t bw, uint8_t cr, uint8_t hdrCount, uint16
 }
 
 int16_t SX126x::reset(bool verify) {
+  // the chip comes out of reset in GFSK
+  this->packetTypeCached = RADIOLIB_SX126X_PACKET_TYPE_GFSK;
+
   // run the reset sequence
   this->mod->hal->pinMode(this->mod->getRst(), this->mod->hal->GpioModeOutput);
   this->mod->hal->digitalWrite(this->mod->getRst(), this->mod->hal->GpioLevelLow);
@@ -276,6 +279,34 @@ int16_t SX126x::transmit(const uint8_t* data, size_t len, uint8_t addr) {
   return(finishTransmit());
 }
 
+int16_t SX126x::preloadTransmit(const uint8_t* data, size_t len) {
+  if(len > RADIOLIB_SX126X_MAX_PACKET_LENGTH) {
+    return(RADIOLIB_ERR_PACKET_TOO_LONG);
+  }
+
+  // buffer access is allowed in Rx, so there is no need to go to standby
+  int16_t state = writeBuffer(data, len, this->txBaseAddr);
+  RADIOLIB_ASSERT(state);
+
+  this->txPreloadLen = len;
+  this->txPreloaded = true;
+  return(state);
+}
+
+int16_t SX126x::transmitPreloaded() {
+  if(!this->txPreloaded) {
+    return(RADIOLIB_ERR_NULL_POINTER);
+  }
+  return(transmit(NULL, this->txPreloadLen));
+}
+
+int16_t SX126x::setBufferSplit(uint8_t txBaseAddress, uint8_t rxBaseAddress) {
+  this->txBaseAddr = txBaseAddress;
+  this->rxBaseAddr = rxBaseAddress;
+  this->txPreloaded = false;
+  return(setBufferBaseAddress(this->txBaseAddr, this->rxBaseAddr));
+}
+
 int16_t SX126x::receive(uint8_t* data, size_t len, RadioLibTime_t timeout) {
   // set mode to standby
   int16_t state = standby();
@@ -448,7 +479,7 @@ int16_t SX126x::hopLRFHSS() {
     return(RADIOLIB_ERR_TX_TIMEOUT);
   }
 
-  int16_t state = this->setLRFHSSHop(this->lrFhssHopNum % 16);
+  int16_t state = this->setLRFHSSHop(this->lrFhssHopNum % RADIOLIB_SX126X_LR_FHSS_HOP_SLOTS);
   RADIOLIB_ASSERT(state);
   return(clearIrqStatus());
 }
@@ -568,7 +599,7 @@ int16_t SX126x::startReceiveCommon(uint32_t timeout, RadioLibIrqFlags_t irqFlags
   RADIOLIB_ASSERT(state);
 
   // set buffer pointers
-  state = setBufferBaseAddress();
+  state = setBufferBaseAddress(this->txBaseAddr, this->rxBaseAddr);
   RADIOLIB_ASSERT(state);
 
   // clear interrupt flags
@@ -710,6 +741,23 @@ float SX126x::getRSSI(bool packet) {
   }
 }
 
+int16_t SX126x::sweepRssi(float freq, RadioLibTime_t settleUs, uint8_t* rssiRaw) {
+  // XOSC standby keeps the TCXO running, so Rx is back within microseconds
+  uint8_t mode = RADIOLIB_SX126X_STANDBY_XOSC;
+  int16_t state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_STANDBY, &mode, 1);
+  RADIOLIB_ASSERT(state);
+
+  state = setFrequencyRaw(freq);
+  RADIOLIB_ASSERT(state);
+
+  state = setRx(RADIOLIB_SX126X_RX_TIMEOUT_INF);
+  RADIOLIB_ASSERT(state);
+
+  // let the RSSI averaging catch up with the new channel
+  this->mod->hal->delayMicroseconds(settleUs);
+  return(this->mod->SPIreadStream(RADIOLIB_SX126X_CMD_GET_RSSI_INST, rssiRaw, 1));
+}
+
 float SX126x::getSNR() {
   // check active modem
   if(getPacketType() != RADIOLIB_SX126X_PACKET_TYPE_LORA) {
@@ -741,6 +789,10 @@ float SX126x::getFrequencyError() {
   RADIOLIB_ASSERT(state);
   state = readRegister(RADIOLIB_SX126X_REG_FREQ_ERROR_RX_CRC + 2, &efeRaw[2], 1);
   RADIOLIB_ASSERT(state);
+  return(parseFrequencyError(efeRaw));
+}
+
+float SX126x::parseFrequencyError(const uint8_t* efeRaw) const {
   uint32_t efe = ((uint32_t) efeRaw[0] << 16) | ((uint32_t) efeRaw[1] << 8) | efeRaw[2];
   efe &= 0x0FFFFF;
 
@@ -780,6 +832,77 @@ size_t SX126x::getPacketLength(bool update, uint8_t* offset) {
   return((size_t)rxBufStatus[0]);
 }
 
+int16_t SX126x::getPacketInfo(PacketInfo_t* info) {
+  // IRQ status
+  uint8_t irqRaw[2] = {0, 0};
+  int16_t state = this->mod->SPIreadStream(RADIOLIB_SX126X_CMD_GET_IRQ_STATUS, irqRaw, 2);
+  RADIOLIB_ASSERT(state);
+  info->irqFlags = ((uint16_t)irqRaw[0] << 8) | (uint16_t)irqRaw[1];
+
+  // Rx buffer status - length and offset are always read, even in implicit header mode
+  uint8_t rxBufStatus[2] = {0, 0};
+  state = this->mod->SPIreadStream(RADIOLIB_SX126X_CMD_GET_RX_BUFFER_STATUS, rxBufStatus, 2);
+  RADIOLIB_ASSERT(state);
+  info->length = rxBufStatus[0];
+  info->offset = rxBufStatus[1];
+
+  // packet status
+  uint8_t pktStatus[3] = {0, 0, 0};
+  state = this->mod->SPIreadStream(RADIOLIB_SX126X_CMD_GET_PACKET_STATUS, pktStatus, 3);
+  RADIOLIB_ASSERT(state);
+
+  // packet type as last set by config(), saves reading it back over SPI
+  if(this->packetTypeCached != RADIOLIB_SX126X_PACKET_TYPE_LORA) {
+    // GFSK packet status is RxStatus, RssiSync, RssiAvg
+    info->rssi = (float)pktStatus[2] / (-2.0f);
+    info->signalRssi = (float)pktStatus[1] / (-2.0f);
+    info->snr = 0;
+    info->freqError = 0;
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // LoRa packet status is RssiPkt, SnrPkt, SignalRssiPkt
+  info->rssi = (float)pktStatus[0] / (-2.0f);
+  info->snr = (float)((int8_t)pktStatus[1]) / 4.0f;
+  info->signalRssi = (float)pktStatus[2] / (-2.0f);
+
+  // frequency error registers are consecutive, so they can be read in a single burst
+  uint8_t efeRaw[3] = {0, 0, 0};
+  state = readRegister(RADIOLIB_SX126X_REG_FREQ_ERROR_RX_CRC, efeRaw, 3);
+  RADIOLIB_ASSERT(state);
+  info->freqError = parseFrequencyError(efeRaw);
+
+  return(state);
+}
+
+int16_t SX126x::readData(uint8_t* data, size_t len, PacketInfo_t* info) {
+  int16_t state = getPacketInfo(info);
+  RADIOLIB_ASSERT(state);
+
+  // check integrity CRC, the same way as readData(data, len)
+  int16_t crcState = RADIOLIB_ERR_NONE;
+  uint16_t irq = info->irqFlags;
+  if((irq & RADIOLIB_SX126X_IRQ_CRC_ERR) || ((irq & RADIOLIB_SX126X_IRQ_HEADER_ERR) && !(irq & RADIOLIB_SX126X_IRQ_HEADER_VALID))) {
+    crcState = RADIOLIB_ERR_CRC_MISMATCH;
+  }
+
+  // length and offset were already captured, no need to query the Rx buffer status again
+  size_t length = info->length;
+  if((len != 0) && (len < length)) {
+    length = len;
+  }
+
+  state = readBuffer(data, length, info->offset);
+  RADIOLIB_ASSERT(state);
+
+  state = clearIrqStatus();
+
+  // check if CRC failed - this is done after reading data to give user the option to keep them
+  RADIOLIB_ASSERT(crcState);
+
+  return(state);
+}
+
 int16_t SX126x::getLoRaRxHeaderInfo(uint8_t* cr, bool* hasCRC) {
   int16_t state = RADIOLIB_ERR_NONE;
 
@@ -1030,6 +1153,12 @@ int16_t SX126x::stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) {
         return(RADIOLIB_ERR_PACKET_TOO_LONG);
       }
 
+      // NULL data means the frame was already written by preloadTransmit
+      bool usePreloaded = (cfg->transmit.data == NULL);
+      if(usePreloaded && (!this->txPreloaded || (cfg->transmit.len != this->txPreloadLen))) {
+        return(RADIOLIB_ERR_NULL_POINTER);
+      }
+
       // maximum packet length is decreased by 1 when address filtering is active
       if((RADIOLIB_SX126X_GFSK_ADDRESS_FILT_OFF != RADIOLIB_SX126X_GFSK_ADDRESS_FILT_OFF) && 
         (cfg->transmit.len > RADIOLIB_SX126X_MAX_PACKET_LENGTH - 1)) {
@@ -1069,13 +1198,20 @@ int16_t SX126x::stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) {
       RADIOLIB_ASSERT(state);
 
       // set buffer pointers
-      state = setBufferBaseAddress();
+      state = setBufferBaseAddress(this->txBaseAddr, this->rxBaseAddr);
       RADIOLIB_ASSERT(state);
 
       // write packet to buffer
       if(modem != RADIOLIB_SX126X_PACKET_TYPE_LR_FHSS) {
-        state = writeBuffer(cfg->transmit.data, cfg->transmit.len);
+        if(!usePreloaded) {
+          state = writeBuffer(cfg->transmit.data, cfg->transmit.len, this->txBaseAddr);
+        }
+        this->txPreloaded = false;
       
+      } else if(usePreloaded) {
+        // LR-FHSS frame is built from the payload, it cannot be preloaded
+        return(RADIOLIB_ERR_NULL_POINTER);
+
       } else {
         // first, reset the LR-FHSS state machine
         state = resetLRFHSS();
@@ -1095,25 +1231,27 @@ int16_t SX126x::stageMode(RadioModeType_t mode, RadioModeConfig_t* cfg) {
         state = buildLRFHSSPacket(cfg->transmit.data, cfg->transmit.len, frame, &frameLen, &this->lrFhssFrameBitsRem, &this->lrFhssFrameHopsRem);
         RADIOLIB_ASSERT(state);
 
+        // compute the complete hop sequence now, so that hop interrupts only have to copy it
+        state = buildLRFHSSHops();
+        RADIOLIB_ASSERT(state);
+
         // FIXME check max len for FHSS
-        state = writeBuffer(frame, frameLen);
+        state = writeBuffer(frame, frameLen, this->txBaseAddr);
         RADIOLIB_ASSERT(state);
 
         // activate hopping
-        const uint8_t hopCfg[] = { RADIOLIB_SX126X_HOPPING_ENABLED, (uint8_t)frameLen, (uint8_t)this->lrFhssFrameHopsRem };
+        const uint8_t hopCfg[] = { RADIOLIB_SX126X_HOPPING_ENABLED, (uint8_t)frameLen, (uint8_t)this->lrFhssHopCount };
         state = writeRegister(RADIOLIB_SX126X_REG_HOPPING_ENABLE, hopCfg, 3);
         RADIOLIB_ASSERT(state);
 
-        // write the initial hopping table
-        uint8_t initHops = this->lrFhssFrameHopsRem;
-        if(initHops > 16) {
-          initHops = 16;
+        // write the initial hopping table, the slots are contiguous so this is a single burst
+        uint8_t initHops = this->lrFhssHopCount;
+        if(initHops > RADIOLIB_SX126X_LR_FHSS_HOP_SLOTS) {
+          initHops = RADIOLIB_SX126X_LR_FHSS_HOP_SLOTS;
         };
-        for(size_t i = 0; i < initHops; i++) {
-          // set the hop frequency and symbols
-          state = this->setLRFHSSHop(i);
-          RADIOLIB_ASSERT(state);
-        }
+        state = writeRegister(RADIOLIB_SX126X_REG_LR_FHSS_NUM_SYMBOLS_FREQX_MSB(0), this->lrFhssHops[0], initHops * RADIOLIB_SX126X_LR_FHSS_HOP_REG_LEN);
+        RADIOLIB_ASSERT(state);
+        this->lrFhssHopNum = initHops;
       
       }
       RADIOLIB_ASSERT(state);
@@ -28,6 +28,11 @@
 #define RADIOLIB_SX126X_LR_FHSS_FRAG_BITS                       (48)
 #define RADIOLIB_SX126X_LR_FHSS_BLOCK_PREAMBLE_BITS             (2)
 #define RADIOLIB_SX126X_LR_FHSS_BLOCK_BITS                      (RADIOLIB_SX126X_LR_FHSS_FRAG_BITS + RADIOLIB_SX126X_LR_FHSS_BLOCK_PREAMBLE_BITS)
+#define RADIOLIB_SX126X_LR_FHSS_HOP_SLOTS                       (16)
+#define RADIOLIB_SX126X_LR_FHSS_HOP_REG_LEN                     (6)
+
+// longest frame that fits the data buffer: one header hop, the rest payload blocks
+#define RADIOLIB_SX126X_LR_FHSS_MAX_HOPS                        ((RADIOLIB_SX126X_MAX_PACKET_LENGTH*8 - RADIOLIB_SX126X_LR_FHSS_HEADER_BITS) / RADIOLIB_SX126X_LR_FHSS_BLOCK_BITS + 2)
 
 /*!
   \class SX126x
@@ -54,6 +59,34 @@ class SX126x: public PhysicalLayer {
       int8_t paVal;
     };
 
+    /*!
+      \struct PacketInfo_t
+      \brief Metadata of the last received packet, as captured by getPacketInfo.
+    */
+    struct PacketInfo_t {
+      /*! \brief Raw SX126x IRQ status at the time of capture. */
+      uint16_t irqFlags;
+
+      /*! \brief Length of the received packet in bytes. */
+      uint8_t length;
+
+      /*! \brief Offset of the received packet in the Rx buffer. */
+      uint8_t offset;
+
+      /*! \brief Average RSSI over the last packet in dBm (LoRa RssiPkt, GFSK RssiAvg). */
+      float rssi;
+
+      /*! \brief SNR of the last packet in dB. Only valid for LoRa modem. */
+      float snr;
+
+      /*! \brief RSSI of the despread LoRa signal in dBm (SignalRssiPkt), an estimate of
+      the signal alone, unlike rssi. GFSK reports RssiSync here instead. */
+      float signalRssi;
+
+      /*! \brief Frequency error in Hz. Only valid for LoRa modem. */
+      float freqError;
+    };
+
     /*!
       \brief Default constructor.
       \param mod Instance of Module that will be used to communicate with the radio.
@@ -145,6 +178,34 @@ class SX126x: public PhysicalLayer {
     */
     int16_t transmit(const uint8_t* data, size_t len, uint8_t addr = 0) override;
 
+    /*!
+      \brief Writes a frame to the Tx region of the data buffer ahead of time, e.g. while still in Rx mode.
+      The following transmit or startTransmit call with data set to NULL will then skip the buffer write
+      and only has to apply the packet parameters and issue SetTx.
+      Rx and Tx regions should be separated by setBufferSplit, otherwise the preloaded frame
+      may be overwritten by an incoming packet.
+      \param data Binary data to be preloaded.
+      \param len Number of bytes to preload.
+      \returns \ref status_codes
+    */
+    int16_t preloadTransmit(const uint8_t* data, size_t len);
+
+    /*!
+      \brief Blocking transmit of the frame written by preloadTransmit.
+      \returns \ref status_codes
+    */
+    int16_t transmitPreloaded();
+
+    /*!
+      \brief Sets base addresses of the Tx and Rx regions of the 256-byte data buffer.
+      Defaults to 0 for both, i.e. the whole buffer is shared. The addresses are kept
+      for all subsequent transmissions and receptions.
+      \param txBaseAddress Base address of the Tx region.
+      \param rxBaseAddress Base address of the Rx region.
+      \returns \ref status_codes
+    */
+    int16_t setBufferSplit(uint8_t txBaseAddress, uint8_t rxBaseAddress);
+
     /*!
       \brief Blocking binary receive method.
       Overloads for string-based transmissions are implemented in PhysicalLayer.
@@ -217,7 +278,10 @@ class SX126x: public PhysicalLayer {
     /*!
       \brief Handle LR-FHSS hop. 
       When using LR-FHSS in interrupt-driven mode, this method MUST be called each time an interrupt is triggered!
-      \returns \ref status_codes
+      The whole hop sequence is computed when transmission starts, so this only copies the next
+      precomputed entry into the hop table and is short enough to be called directly from the DIO1 ISR.
+      \returns \ref status_codes, RADIOLIB_ERR_TX_TIMEOUT when the interrupt was not a hop request
+      (i.e. transmission is done).
     */
     int16_t hopLRFHSS();
 
@@ -539,6 +603,19 @@ class SX126x: public PhysicalLayer {
     */
     float getRSSI(bool packet);
 
+    /*!
+      \brief Retunes the receiver for one spectrum sweep step and reads the instantaneous RSSI there.
+      Skips the range check and image calibration of setFrequency and issues four single-command
+      SPI transactions: SetStandby (XOSC), SetRfFrequency, SetRx (continuous) and GetRssiInst.
+      The RF switch is left alone, so startReceive should be called once before the sweep,
+      after tuning into the swept band with setFrequency to calibrate the image rejection.
+      \param freq Frequency in MHz.
+      \param settleUs Time to wait in Rx before reading the RSSI, in microseconds.
+      \param rssiRaw Pointer to store the raw RSSI to, in -0.5 dBm units.
+      \returns \ref status_codes
+    */
+    int16_t sweepRssi(float freq, RadioLibTime_t settleUs, uint8_t* rssiRaw);
+
     /*!
       \brief Gets SNR (Signal to Noise Ratio) of the last received packet. Only available for LoRa modem.
       \returns SNR of the last received packet in dB.
@@ -569,6 +646,25 @@ class SX126x: public PhysicalLayer {
     */
     size_t getPacketLength(bool update, uint8_t* offset);
 
+    /*!
+      \brief Capture IRQ status, Rx buffer status, packet status and frequency error of the last received packet
+      in one pass, issuing one SPI transaction per radio command. Should be called once after RxDone,
+      the returned structure can then be used instead of getRSSI, getSNR, getFrequencyError and getPacketLength.
+      \param info Pointer to structure to save the packet metadata.
+      \returns \ref status_codes
+    */
+    int16_t getPacketInfo(PacketInfo_t* info);
+
+    /*!
+      \brief Reads data received after calling startReceive method and captures the packet metadata
+      in the same pass (see getPacketInfo). The packet length does not have to be queried beforehand.
+      \param data Pointer to array to save the received binary data.
+      \param len Maximum number of bytes that will be read. When set to 0, the whole packet will be read.
+      \param info Pointer to structure to save the packet metadata.
+      \returns \ref status_codes
+    */
+    int16_t readData(uint8_t* data, size_t len, PacketInfo_t* info);
+
     /*!
       \brief Get LoRa header information from last received packet. Only valid in explicit header mode.
       \param cr Pointer to variable to store the coding rate.
@@ -894,6 +990,14 @@ class SX126x: public PhysicalLayer {
     uint8_t invertIQEnabled = RADIOLIB_SX126X_LORA_IQ_STANDARD;
     uint32_t rxTimeout = 0;
 
+    uint8_t txBaseAddr = 0x00;
+    uint8_t rxBaseAddr = 0x00;
+    size_t txPreloadLen = 0;
+    bool txPreloaded = false;
+
+    // packet type written by the last config(), for getPacketInfo()
+    uint8_t packetTypeCached = RADIOLIB_SX126X_PACKET_TYPE_GFSK;
+
     // LR-FHSS stuff - there's a lot of it because all the encoding happens in software
     uint8_t lrFhssCr = RADIOLIB_SX126X_LR_FHSS_CR_2_3;
     uint8_t lrFhssBw = RADIOLIB_SX126X_LR_FHSS_BW_722_66;
@@ -909,6 +1013,11 @@ class SX126x: public PhysicalLayer {
     size_t lrFhssFrameHopsRem = 0;
     size_t lrFhssHopNum = 0;
 
+    // per-frame hop sequence, each entry is the register image of one hop table slot
+    // (2-byte symbol count followed by 4-byte frequency), built before transmission starts
+    uint8_t lrFhssHops[RADIOLIB_SX126X_LR_FHSS_MAX_HOPS][RADIOLIB_SX126X_LR_FHSS_HOP_REG_LEN] = {{ 0 }};
+    size_t lrFhssHopCount = 0;
+
     int16_t modSetup(float tcxoVoltage, bool useRegulatorLDO, uint8_t modem);
     int16_t config(uint8_t modem);
     bool findChip(const char* verStr);
@@ -924,10 +1033,13 @@ class SX126x: public PhysicalLayer {
     int16_t fixInvertedIQ(uint8_t iqConfig);
     int16_t fixGFSK();
 
+    float parseFrequencyError(const uint8_t* efeRaw) const;
+
     // LR-FHSS utilities
     int16_t buildLRFHSSPacket(const uint8_t* in, size_t in_len, uint8_t* out, size_t* out_len, size_t* out_bits, size_t* out_hops);
     int16_t resetLRFHSS();
     uint16_t stepLRFHSS();
+    int16_t buildLRFHSSHops();
     int16_t setLRFHSSHop(uint8_t index);
 
     void regdump();
@@ -66,11 +66,7 @@ int16_t SX126x::buildLRFHSSPacket(const uint8_t* in, size_t in_len, uint8_t* out
   }
 
   // calculate the CRC-16 over the whitened data, looks like something custom
-  RadioLibCRCInstance.size = 16;
-  RadioLibCRCInstance.poly = 0x755B;
-  RadioLibCRCInstance.init = 0xFFFF;
-  RadioLibCRCInstance.out = 0x0000;
-  uint16_t crc16 = RadioLibCRCInstance.checksum(out, in_len);
+  uint16_t crc16 = RadioLibCRCTable<16, 0x755B, 0xFFFF, 0x0000>::checksum(out, in_len);
 
   // add payload CRC
   out[in_len] = (crc16 >> 8) & 0xFF;
@@ -181,16 +177,13 @@ int16_t SX126x::buildLRFHSSPacket(const uint8_t* in, size_t in_len, uint8_t* out
   raw_header[3] = ((this->lrFhssHopSeqId & 0x000F) << 4);
 
   // CRC-8 used seems to based on 8H2F, but without final XOR
-  RadioLibCRCInstance.size = 8;
-  RadioLibCRCInstance.poly = 0x2F;
-  RadioLibCRCInstance.init = 0xFF;
-  RadioLibCRCInstance.out = 0x00;
+  typedef RadioLibCRCTable<8, 0x2F, 0xFF, 0x00> HeaderCRC;
 
   uint16_t header_offset = 0;
   for(size_t i = 0; i < this->lrFhssHdrCount; i++) {
     // insert index and calculate the header CRC
     raw_header[3] = (raw_header[3] & ~0x0C) | ((this->lrFhssHdrCount - i - 1) << 2);
-    raw_header[4] = RadioLibCRCInstance.checksum(raw_header, (RADIOLIB_SX126X_LR_FHSS_HDR_BYTES/2 - 1));
+    raw_header[4] = HeaderCRC::checksum(raw_header, (RADIOLIB_SX126X_LR_FHSS_HDR_BYTES/2 - 1));
 
     // convolutional encode
     uint8_t coded_header[RADIOLIB_SX126X_LR_FHSS_HDR_BYTES] = { 0 };
@@ -341,51 +334,71 @@ uint16_t SX126x::stepLRFHSS() {
   return(hop);
 }
 
-int16_t SX126x::setLRFHSSHop(uint8_t index) {
-  if(!this->lrFhssFrameHopsRem) {
-    return(RADIOLIB_ERR_NONE);
-  }
-
-  uint16_t hop = stepLRFHSS();
-  int16_t freq_table = hop - 1;
-  if(freq_table >= (int16_t)(this->lrFhssNgrid >> 1)) {
-    freq_table -= this->lrFhssNgrid;
+int16_t SX126x::buildLRFHSSHops() {
+  if(this->lrFhssFrameHopsRem > RADIOLIB_SX126X_LR_FHSS_MAX_HOPS) {
+    return(RADIOLIB_ERR_PACKET_TOO_LONG);
   }
 
+  // grid parameters and the center frequency are the same for every hop
   uint32_t nb_channel_in_grid = this->lrFhssGridNonFcc ? 8 : 52;
   uint32_t grid_offset = (1 + (this->lrFhssNgrid % 2)) * (nb_channel_in_grid / 2);
   uint32_t grid_in_pll_steps = this->lrFhssGridNonFcc ? 4096 : 26624;
   uint32_t frf = (this->freqMHz * (uint32_t(1) << RADIOLIB_SX126X_DIV_EXPONENT)) / RADIOLIB_SX126X_CRYSTAL_FREQ;
-  uint32_t freq_raw = frf - freq_table * grid_in_pll_steps - grid_offset * 512;
 
-  if((this->lrFhssHopNum < this->lrFhssHdrCount)) {
-    if((((this->lrFhssHdrCount - this->lrFhssHopNum) % 2) == 0)) {
-      freq_raw += 256;
+  this->lrFhssHopCount = 0;
+  while(this->lrFhssFrameHopsRem) {
+    size_t hopNum = this->lrFhssHopCount;
+    uint16_t hop = stepLRFHSS();
+    int16_t freq_table = hop - 1;
+    if(freq_table >= (int16_t)(this->lrFhssNgrid >> 1)) {
+      freq_table -= this->lrFhssNgrid;
     }
+
+    uint32_t freq_raw = frf - freq_table * grid_in_pll_steps - grid_offset * 512;
+    if((hopNum < this->lrFhssHdrCount)) {
+      if((((this->lrFhssHdrCount - hopNum) % 2) == 0)) {
+        freq_raw += 256;
+      }
+    }
+
+    // (LR_FHSS_HEADER_BITS + pulse_shape_compensation) symbols on first sync_word, LR_FHSS_HEADER_BITS on
+    // next sync_words, LR_FHSS_BLOCK_BITS on payload
+    uint16_t numSymbols = RADIOLIB_SX126X_LR_FHSS_BLOCK_BITS;
+    if(hopNum == 0) {
+      numSymbols = RADIOLIB_SX126X_LR_FHSS_HEADER_BITS + 1; // the +1 is "pulse_shape_compensation", but it's constant in the demo
+    } else if(hopNum < this->lrFhssHdrCount) {
+      numSymbols = RADIOLIB_SX126X_LR_FHSS_HEADER_BITS;
+    } else if(this->lrFhssFrameBitsRem < RADIOLIB_SX126X_LR_FHSS_BLOCK_BITS) {
+      numSymbols = this->lrFhssFrameBitsRem;
+    }
+
+    // hop length in symbols is followed by the frequency in the register map,
+    // so each entry can be written to its slot in a single transaction
+    uint8_t* entry = this->lrFhssHops[hopNum];
+    entry[0] = (uint8_t)((numSymbols >> 8) & 0xFF);
+    entry[1] = (uint8_t)(numSymbols & 0xFF);
+    entry[2] = (uint8_t)((freq_raw >> 24) & 0xFF);
+    entry[3] = (uint8_t)((freq_raw >> 16) & 0xFF);
+    entry[4] = (uint8_t)((freq_raw >> 8) & 0xFF);
+    entry[5] = (uint8_t)(freq_raw & 0xFF);
+
+    this->lrFhssFrameBitsRem -= numSymbols;
+    this->lrFhssFrameHopsRem--;
+    this->lrFhssHopCount++;
   }
 
-  const uint8_t frq[4] = { (uint8_t)((freq_raw >> 24) & 0xFF), (uint8_t)((freq_raw >> 16) & 0xFF), (uint8_t)((freq_raw >> 8) & 0xFF), (uint8_t)(freq_raw & 0xFF) };
-  int16_t state = writeRegister(RADIOLIB_SX126X_REG_LR_FHSS_FREQX_0(index), frq, sizeof(freq_raw));
-  RADIOLIB_ASSERT(state);
+  this->lrFhssHopNum = 0;
+  return(RADIOLIB_ERR_NONE);
+}
 
-  // (LR_FHSS_HEADER_BITS + pulse_shape_compensation) symbols on first sync_word, LR_FHSS_HEADER_BITS on
-  // next sync_words, LR_FHSS_BLOCK_BITS on payload
-  uint16_t numSymbols = RADIOLIB_SX126X_LR_FHSS_BLOCK_BITS;
-  if(index == 0) {
-    numSymbols = RADIOLIB_SX126X_LR_FHSS_HEADER_BITS + 1; // the +1 is "pulse_shape_compensation", but it's constant in the demo
-  } else if(index < this->lrFhssHdrCount) {
-    numSymbols = RADIOLIB_SX126X_LR_FHSS_HEADER_BITS;
-  } else if(this->lrFhssFrameBitsRem < RADIOLIB_SX126X_LR_FHSS_BLOCK_BITS) {
-    numSymbols = this->lrFhssFrameBitsRem;
+int16_t SX126x::setLRFHSSHop(uint8_t index) {
+  if(this->lrFhssHopNum >= this->lrFhssHopCount) {
+    return(RADIOLIB_ERR_NONE);
   }
 
-  // write hop length in symbols
-  const uint8_t sym[2] = { (uint8_t)((numSymbols >> 8) & 0xFF), (uint8_t)(numSymbols & 0xFF) };
-  state = writeRegister(RADIOLIB_SX126X_REG_LR_FHSS_NUM_SYMBOLS_FREQX_MSB(index), sym, sizeof(uint16_t));
+  int16_t state = writeRegister(RADIOLIB_SX126X_REG_LR_FHSS_NUM_SYMBOLS_FREQX_MSB(index), this->lrFhssHops[this->lrFhssHopNum], RADIOLIB_SX126X_LR_FHSS_HOP_REG_LEN);
   RADIOLIB_ASSERT(state);
 
-  this->lrFhssFrameBitsRem -= numSymbols;
-  this->lrFhssFrameHopsRem--;
   this->lrFhssHopNum++;
   return(RADIOLIB_ERR_NONE);
 }
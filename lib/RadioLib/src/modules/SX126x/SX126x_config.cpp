@@ -775,7 +775,7 @@ int16_t SX126x::setFrequencyRaw(float freq) {
 
 int16_t SX126x::config(uint8_t modem) {
   // reset buffer base address
-  int16_t state = setBufferBaseAddress();
+  int16_t state = setBufferBaseAddress(this->txBaseAddr, this->rxBaseAddr);
   RADIOLIB_ASSERT(state);
 
   // set modem
@@ -783,6 +783,7 @@ int16_t SX126x::config(uint8_t modem) {
   data[0] = modem;
   state = this->mod->SPIwriteStream(RADIOLIB_SX126X_CMD_SET_PACKET_TYPE, data, 1);
   RADIOLIB_ASSERT(state);
+  this->packetTypeCached = modem;
 
   // set Rx/Tx fallback mode to STDBY_RC
   data[0] = this->standbyXOSC ? RADIOLIB_SX126X_RX_TX_FALLBACK_MODE_STDBY_XOSC : RADIOLIB_SX126X_RX_TX_FALLBACK_MODE_STDBY_RC;
@@ -0,0 +1,193 @@
+#if !defined(_RADIOLIB_CRC_H)
+#define _RADIOLIB_CRC_H
+
+#include "../TypeDef.h"
+#include "../Module.h"
+#include "Utils.h"
+
+// CCITT CRC properties (used by AX.25)
+#define RADIOLIB_CRC_CCITT_POLY                                 (0x1021)
+#define RADIOLIB_CRC_CCITT_INIT                                 (0xFFFF)
+#define RADIOLIB_CRC_CCITT_OUT                                  (0xFFFF)
+
+/*!
+  \class RadioLibCRC
+  \brief Class to calculate CRCs of varying formats.
+*/
+class RadioLibCRC {
+  public:
+    /*!
+      \brief CRC size in bits.
+    */
+    uint8_t size = 8;
+
+    /*!
+      \brief CRC polynomial.
+    */
+    uint32_t poly = 0;
+
+    /*!
+      \brief Initial value.
+    */
+    uint32_t init = 0;
+
+    /*!
+      \brief Final XOR value.
+    */
+    uint32_t out = 0;
+
+    /*!
+      \brief Whether to reflect input bytes.
+    */
+    bool refIn = false;
+
+    /*!
+      \brief Whether to reflect the result.
+    */
+    bool refOut = false;
+
+    /*!
+      \brief Default constructor.
+    */
+    RadioLibCRC();
+
+    /*!
+      \brief Calculate checksum of a buffer.
+      \param buff Buffer to calculate the checksum over.
+      \param len Size of the buffer in bytes.
+      \returns The resulting checksum.
+    */
+    uint32_t checksum(const uint8_t* buff, size_t len);
+};
+
+// the global singleton
+extern RadioLibCRC RadioLibCRCInstance;
+
+// compile-time index sequence (C++11 compatible, logarithmic instantiation depth)
+template<size_t... I> struct RadioLibIndexSeq { typedef RadioLibIndexSeq type; };
+template<class A, class B> struct RadioLibIndexConcat;
+template<size_t... I, size_t... J> struct RadioLibIndexConcat<RadioLibIndexSeq<I...>, RadioLibIndexSeq<J...>>
+  : RadioLibIndexSeq<I..., (sizeof...(I) + J)...> {};
+template<size_t N> struct RadioLibMakeIndexSeq
+  : RadioLibIndexConcat<typename RadioLibMakeIndexSeq<N/2>::type, typename RadioLibMakeIndexSeq<N - N/2>::type> {};
+template<> struct RadioLibMakeIndexSeq<0> : RadioLibIndexSeq<> {};
+template<> struct RadioLibMakeIndexSeq<1> : RadioLibIndexSeq<0> {};
+
+/*!
+  \class RadioLibCRCTable
+  \brief Table-driven CRC for configurations known at compile time.
+  Produces the same results as RadioLibCRC with the same parameters. Lookup tables are generated
+  at compile time, separately for each instance. Input reflection is handled by running the reflected
+  algorithm rather than reflecting every byte. See RADIOLIB_CRC_SLICE_BY_4 and RADIOLIB_CRC_BITWISE
+  for the available speed/size trade-offs.
+  \tparam Size CRC size in bits (8 - 32).
+  \tparam Poly CRC polynomial.
+  \tparam Init Initial value.
+  \tparam Out Final XOR value.
+  \tparam RefIn Whether to reflect input bytes.
+  \tparam RefOut Whether to reflect the result.
+*/
+template<uint8_t Size, uint32_t Poly, uint32_t Init, uint32_t Out, bool RefIn = false, bool RefOut = false>
+class RadioLibCRCTable {
+  static_assert((Size >= 8) && (Size <= 32), "CRC size must be between 8 and 32 bits");
+
+  public:
+    /*!
+      \brief Calculate checksum of a buffer.
+      \param buff Buffer to calculate the checksum over.
+      \param len Size of the buffer in bytes.
+      \returns The resulting checksum.
+    */
+    static uint32_t checksum(const uint8_t* buff, size_t len) {
+      #if RADIOLIB_CRC_BITWISE
+        RadioLibCRC crc;
+        crc.size = Size;
+        crc.poly = Poly;
+        crc.init = Init;
+        crc.out = Out;
+        crc.refIn = RefIn;
+        crc.refOut = RefOut;
+        return(crc.checksum(buff, len));
+      #else
+        uint32_t reg = RefIn ? reflect(Init, Size) : (Init << Shift);
+        size_t pos = 0;
+
+        #if RADIOLIB_CRC_SLICE_BY_4
+        for(; pos + 4 <= len; pos += 4) {
+          if(RefIn) {
+            reg ^= (uint32_t)buff[pos] | ((uint32_t)buff[pos + 1] << 8) | ((uint32_t)buff[pos + 2] << 16) | ((uint32_t)buff[pos + 3] << 24);
+            reg = lut.t[3][reg & 0xFF] ^ lut.t[2][(reg >> 8) & 0xFF] ^ lut.t[1][(reg >> 16) & 0xFF] ^ lut.t[0][reg >> 24];
+          } else {
+            reg ^= ((uint32_t)buff[pos] << 24) | ((uint32_t)buff[pos + 1] << 16) | ((uint32_t)buff[pos + 2] << 8) | (uint32_t)buff[pos + 3];
+            reg = lut.t[3][reg >> 24] ^ lut.t[2][(reg >> 16) & 0xFF] ^ lut.t[1][(reg >> 8) & 0xFF] ^ lut.t[0][reg & 0xFF];
+          }
+        }
+        #endif
+
+        for(; pos < len; pos++) {
+          if(RefIn) {
+            reg = (reg >> 8) ^ lut.t[0][(reg ^ buff[pos]) & 0xFF];
+          } else {
+            reg = (reg << 8) ^ lut.t[0][(reg >> 24) ^ buff[pos]];
+          }
+        }
+
+        // same order as RadioLibCRC: final XOR first, then output reflection
+        uint32_t crc;
+        if(RefIn && RefOut) {
+          crc = reg ^ reflect(Out, Size);
+        } else if(RefIn) {
+          crc = rlb_reflect(reg, Size) ^ Out;
+        } else if(RefOut) {
+          crc = rlb_reflect((reg >> Shift) ^ Out, Size);
+        } else {
+          crc = (reg >> Shift) ^ Out;
+        }
+        return(crc & Mask);
+      #endif
+    }
+
+#if !RADIOLIB_GODMODE
+  private:
+#endif
+    static constexpr uint8_t Shift = 32 - Size;
+    static constexpr uint32_t Mask = (uint32_t)0xFFFFFFFF >> (32 - Size);
+
+    #if RADIOLIB_CRC_SLICE_BY_4
+    static constexpr size_t Slices = 4;
+    #else
+    static constexpr size_t Slices = 1;
+    #endif
+
+    struct Lut {
+      uint32_t t[Slices][256];
+    };
+
+    static constexpr uint32_t reflect(uint32_t in, uint8_t bits) {
+      return(bits == 0 ? 0 : (((in & 1) << (bits - 1)) | reflect(in >> 1, bits - 1)));
+    }
+
+    // one bit of the register update, MSB-first on a left-aligned register or LSB-first on a reflected one
+    static constexpr uint32_t step(uint32_t reg, uint8_t bits) {
+      return(bits == 0 ? reg : step(RefIn ? ((reg & 1) ? ((reg >> 1) ^ reflect(Poly, Size)) : (reg >> 1))
+                                          : ((reg & 0x80000000UL) ? ((reg << 1) ^ (Poly << Shift)) : (reg << 1)), bits - 1));
+    }
+
+    static constexpr uint32_t entry(size_t slice, uint32_t i) {
+      return(slice == 0 ? step(RefIn ? i : (i << 24), 8)
+                        : (RefIn ? ((entry(slice - 1, i) >> 8) ^ entry(0, entry(slice - 1, i) & 0xFF))
+                                 : ((entry(slice - 1, i) << 8) ^ entry(0, entry(slice - 1, i) >> 24))));
+    }
+
+    template<size_t... I>
+    static constexpr Lut generate(RadioLibIndexSeq<I...>) {
+      return(Lut{{ entry(I / 256, I % 256)... }});
+    }
+
+    static constexpr Lut lut = generate(typename RadioLibMakeIndexSeq<Slices * 256>::type());
+};
+
+template<uint8_t Size, uint32_t Poly, uint32_t Init, uint32_t Out, bool RefIn, bool RefOut>
+constexpr typename RadioLibCRCTable<Size, Poly, Init, Out, RefIn, RefOut>::Lut RadioLibCRCTable<Size, Poly, Init, Out, RefIn, RefOut>::lut;
+
+#endif
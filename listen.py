@@ -2,6 +2,7 @@
 """Listen for and decrypt Meshtastic LoRa packets from the Wio Tracker L1."""
 
 import serial, time, glob, sys, re, struct
+from textpack import TEXTPACK_PORTNUM, textpack_unpack
 from cryptography.hazmat.primitives.ciphers import Cipher, algorithms, modes as cmodes
 
 # Meshtastic default AES-128 key (PSK #1, "AQ==" / the default channel key)
@@ -20,7 +21,7 @@ PORTNUM_NAMES = {
     64: "SERIAL",          65: "STORE_FORWARD",    66: "RANGE_TEST",
     67: "TELEMETRY",       68: "ZPS",              69: "SIMULATOR",
     70: "TRACEROUTE",      71: "NEIGHBORINFO",     72: "ATAK_PLUGIN",
-    73: "MAP_REPORT",
+    73: "MAP_REPORT",      256: "PRIVATE",
 }
 
 # ── AES-CTR matching Meshtastic's nonce layout ──────────────────────────
@@ -91,6 +92,11 @@ def handle_packet(raw):
     print(f"  From: {format_node(from_node)}  To: {dest}  Hops: {hop_start - hop_limit}/{hop_start}")
     print(f"  Port: {port_name} ({portnum})  ID: 0x{packet_id:08x}  Ch: {channel}")
 
+    if portnum == TEXTPACK_PORTNUM and isinstance(payload, (bytes, bytearray)):
+        text = textpack_unpack(payload)
+        print(f"  Packed text: {len(payload)} -> {len(text)} bytes")
+        payload, portnum = text, 1
+
     if portnum == 1:  # TEXT_MESSAGE
         try:
             print(f"  Message: {payload.decode('utf-8')}")
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""Decoder and dictionary trainer for LoRaWAN payloads packed by src/lwpack.cpp.
+
+  lwpack.py <hex> ...           decode packed FRMPayloads (FPort 2)
+  lwpack.py train corpus.txt    print a dictionary for lwpDict[]
+"""
+
+import sys
+from textpack import textpack_read_symbol
+
+LWPACK_FPORT = 2
+DIST_BITS, LEN_BITS, MIN_MATCH = 9, 4, 3
+
+# must match lwpDict in lwpack.cpp
+LWPACK_DICT = (
+    b" fromgood  radio  switchmeet at N, 8.54 forward minutesentrances"
+    b"ensor 3 receiveed at 14:0signal is ing messagewater level the re"
+    b"lay is position 47.37latest readingschecking in frommotion detec"
+    b"ted tus: ok, uptime temperature  C, humidity  %, battery 3. the "
+)
+
+def lwpack_unpack(buf, dictionary=LWPACK_DICT):
+    """Decode a packed payload.
+
+    Bit stream, MSB first: '1' + textpack code is a literal, '0' + distance-1
+    (9 bits) + length-3 (4 bits) copies from the dictionary followed by the
+    output so far. Padding is 1 bits, which end in an incomplete literal.
+    """
+    window = bytearray(dictionary)
+    start = len(window)
+    bits = "".join(f"{b:08b}" for b in buf)
+    i = 0
+    while i < len(bits):
+        flag = bits[i]; i += 1
+        if flag == "1":
+            b, i = textpack_read_symbol(bits, i)
+            if b is None:
+                break
+            window.append(b)
+        else:
+            if i + DIST_BITS + LEN_BITS > len(bits):
+                break
+            dist = int(bits[i : i + DIST_BITS], 2) + 1; i += DIST_BITS
+            length = int(bits[i : i + LEN_BITS], 2) + MIN_MATCH; i += LEN_BITS
+            for _ in range(length):
+                window.append(window[-dist])
+    return bytes(window[start:])
+
+def train(lines, size=256, min_len=4, max_len=16):
+    """Greedy dictionary: repeatedly take the substring that covers the
+    most corpus bytes, then cut it out of the corpus so its occurrences
+    aren't counted twice."""
+    lines = [l for l in lines if l]
+    picked = []
+    used = 0
+    while used < size:
+        counts = {}
+        for l in lines:
+            seen = set()
+            for n in range(min_len, max_len + 1):
+                for s in range(len(l) - n + 1):
+                    sub = l[s : s + n]
+                    if b"\0" in sub or sub in seen:
+                        continue
+                    seen.add(sub)
+                    counts[sub] = counts.get(sub, 0) + 1
+        best = max(((c * (len(s) - 2), s) for s, c in counts.items() if c > 1),
+                   default=(0, None))[1]
+        if best is None:
+            break
+        best = best[: size - used]
+        picked.append(best)
+        used += len(best)
+        lines = [l.replace(best, b"\0") for l in lines]
+    # most used last: the nearest entries to the payload
+    return b"".join(reversed(picked))
+
+def c_literal(d, width=64):
+    out = []
+    for s in range(0, len(d), width):
+        chunk = d[s : s + width].decode("latin-1")
+        chunk = chunk.replace("\\", "\\\\").replace('"', '\\"').replace("\n", "\\n")
+        out.append(f'    "{chunk}"')
+    return "\n".join(out)
+
+if __name__ == "__main__":
+    if len(sys.argv) == 3 and sys.argv[1] == "train":
+        with open(sys.argv[2], "rb") as f:
+            d = train(f.read().split(b"\n"))
+        print(f"// {len(d)} bytes")
+        print(c_literal(d))
+    else:
+        for arg in sys.argv[1:]:
+            print(lwpack_unpack(bytes.fromhex(arg)).decode("utf-8", errors="replace"))
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""Write the Wio Tracker L1's sniffer stream (SNIFFER_MODE) to pcap.
+
+    python3 sniff.py [port] capture.pcap
+    python3 sniff.py [port] - | wireshark -k -i -
+"""
+
+import serial, time, glob, sys, struct
+
+BAUD = 115200
+
+SYNC = b"\xc0\xda"
+HDR_LEN = 10                # sync[2] + length[2] + seq[2] + rx_us[4]
+LORATAP_HDR_LEN = 15
+LINKTYPE_LORATAP = 270
+
+# ── record stream ───────────────────────────────────────────────────────
+
+def records(buf):
+    """Split complete records off the front of `buf`.
+
+    Returns ([(seq, rx_us, loratap_packet)], leftover text, rest of buf).
+    Bytes before a sync (boot messages) come back as text; a sync whose
+    LoRaTap header doesn't check out is taken for text too.
+    """
+    out, text = [], bytearray()
+    while True:
+        i = buf.find(SYNC)
+        if i < 0:
+            keep = 1 if buf.endswith(SYNC[:1]) else 0
+            text += buf[:len(buf) - keep]
+            return out, text, buf[len(buf) - keep:]
+        text += buf[:i]
+        buf = buf[i:]
+        if len(buf) < HDR_LEN + 4:
+            return out, text, buf
+        length, seq, rx_us = struct.unpack_from("<HHI", buf, 2)
+        version, hdr_len = buf[HDR_LEN], struct.unpack_from(">H", buf, HDR_LEN + 2)[0]
+        if version != 0 or hdr_len != LORATAP_HDR_LEN or length < HDR_LEN - 4 + hdr_len:
+            text += buf[:1]
+            buf = buf[1:]
+            continue
+        end = 4 + length
+        if len(buf) < end:
+            return out, text, buf
+        out.append((seq, rx_us, bytes(buf[HDR_LEN:end])))
+        buf = buf[end:]
+
+# ── pcap writer ─────────────────────────────────────────────────────────
+
+class Pcap:
+    """pcap with LoRaTap link headers, stamped from the relay's µs clock.
+
+    The first record is anchored to host time; later ones follow the
+    relay's 32-bit timer, unwrapped, so USB latency doesn't jitter them.
+    """
+
+    def __init__(self, f):
+        self.f = f
+        self.base = None
+        self.last_us = 0
+        self.wraps = 0
+        f.write(struct.pack("<IHHiIII", 0xA1B2C3D4, 2, 4, 0, 0, 65535, LINKTYPE_LORATAP))
+        f.flush()
+
+    def write(self, rx_us, packet):
+        if self.base is None:
+            self.base = time.time() - rx_us / 1e6
+        elif rx_us < self.last_us:
+            self.wraps += 1
+        self.last_us = rx_us
+        t = self.base + (self.wraps * 2**32 + rx_us) / 1e6
+        sec = int(t)
+        self.f.write(struct.pack("<IIII", sec, int((t - sec) * 1e6), len(packet), len(packet)))
+        self.f.write(packet)
+        self.f.flush()
+
+# ── serial reader ───────────────────────────────────────────────────────
+
+def main():
+    args = sys.argv[1:]
+    if len(args) == 2:
+        port, path = args
+    elif len(args) == 1:
+        acm = sorted(glob.glob("/dev/ttyACM*"))
+        if not acm:
+            print("No /dev/ttyACM* found. Pass port as argument.", file=sys.stderr)
+            sys.exit(1)
+        port, path = acm[0], args[0]
+    else:
+        print(__doc__.strip(), file=sys.stderr)
+        sys.exit(1)
+
+    out = sys.stdout.buffer if path == "-" else open(path, "wb")
+    pcap = Pcap(out)
+    print(f"Sniffing on {port} into {path}…  Ctrl+C to stop.", file=sys.stderr)
+
+    ser = serial.Serial(port, BAUD, timeout=1)
+    ser.dtr = True
+
+    buf = bytearray()
+    count = lost = 0
+    next_seq = None
+    try:
+        while True:
+            chunk = ser.read(ser.in_waiting or 1)
+            if not chunk:
+                continue
+            buf += chunk
+            recs, text, buf = records(buf)
+            if text:
+                sys.stderr.write(text.decode("utf-8", errors="replace"))
+            for seq, rx_us, packet in recs:
+                if next_seq is not None and seq != next_seq:
+                    gap = (seq - next_seq) & 0xFFFF
+                    lost += gap
+                    print(f"[sniff] {gap} records lost", file=sys.stderr)
+                next_seq = (seq + 1) & 0xFFFF
+                pcap.write(rx_us, packet)
+                count += 1
+    except (KeyboardInterrupt, BrokenPipeError):
+        pass
+    finally:
+        ser.close()
+        if out is not sys.stdout.buffer:
+            out.close()
+        print(f"\n--- {count} records, {lost} lost ---", file=sys.stderr)
+
+if __name__ == "__main__":
+    main()
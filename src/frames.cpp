@@ -0,0 +1,150 @@
+#include <RadioLib.h>
+#include <string.h>
+#include "frames.h"
+#include "crypto.h"
+#include "lwpack.h"
+
+// ── LoRaWAN ABP credentials ─────────────────────────────────────
+const uint8_t nwkSKey[16] = LORAWAN_NWK_SKEY;
+const uint8_t appSKey[16] = LORAWAN_APP_SKEY;
+
+// ─────────────────────────────────────────────────────────────────
+// Encode a Meshtastic Data protobuf
+//   field 1 = portnum (varint)
+//   field 2 = payload (length-delimited)
+//   Returns total encoded length
+// ─────────────────────────────────────────────────────────────────
+size_t encodeDataProtobuf(uint8_t *out, uint32_t portnum,
+                          const uint8_t *payload, size_t payloadLen)
+{
+    size_t pos = 0;
+
+    // field 1, wire type 0 (varint): tag = 0x08
+    out[pos++] = 0x08;
+    // encode portnum as varint
+    uint32_t v = portnum;
+    while (v >= 0x80) {
+        out[pos++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[pos++] = (uint8_t)v;
+
+    // field 2, wire type 2 (length-delimited): tag = 0x12
+    out[pos++] = 0x12;
+    // encode length as varint
+    v = (uint32_t)payloadLen;
+    while (v >= 0x80) {
+        out[pos++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[pos++] = (uint8_t)v;
+
+    // copy payload
+    memcpy(&out[pos], payload, payloadLen);
+    pos += payloadLen;
+
+    return pos;
+}
+
+// ─────────────────────────────────────────────────────────────────
+// LoRaWAN MIC: first 4 bytes of AES-CMAC(NwkSKey, B0 || msg)
+//   `buf` starts with LW_B0_LEN bytes of headroom where the B0 block
+//   is assembled, followed by the msgLen byte message, so the CMAC
+//   runs over the frame in place
+// ─────────────────────────────────────────────────────────────────
+void lorawanMic(uint8_t *buf, size_t msgLen, uint8_t dir,
+                uint32_t devAddr, uint32_t fCnt, uint8_t mic[4])
+{
+    uint8_t *b0 = buf;
+    b0[0]  = 0x49;
+    b0[1]  = 0x00;
+    b0[2]  = 0x00;
+    b0[3]  = 0x00;
+    b0[4]  = 0x00;
+    b0[5]  = dir;
+    b0[6]  = (uint8_t)(devAddr);
+    b0[7]  = (uint8_t)(devAddr >> 8);
+    b0[8]  = (uint8_t)(devAddr >> 16);
+    b0[9]  = (uint8_t)(devAddr >> 24);
+    b0[10] = (uint8_t)(fCnt);
+    b0[11] = (uint8_t)(fCnt >> 8);
+    b0[12] = (uint8_t)(fCnt >> 16);
+    b0[13] = (uint8_t)(fCnt >> 24);
+    b0[14] = 0x00;
+    b0[15] = (uint8_t)(msgLen);
+
+    uint8_t fullMac[16];
+    aes_cmac(nwkSKey, b0, LW_B0_LEN + msgLen, fullMac);
+    memcpy(mic, fullMac, 4);
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Build LoRaWAN Unconfirmed Data Up frame
+//   `buf` starts with LW_B0_LEN bytes of headroom for the MIC B0
+//   block; the frame itself is written at buf + LW_B0_LEN.
+//   With `linkCheck`, a LinkCheckReq is piggybacked in FOpts. With
+//   LORAWAN_PACK_PAYLOAD the payload is packed straight into the
+//   FRMPayload (lwpack.h) and sent on LORAWAN_PACK_FPORT when that is
+//   shorter; the bytes saved are returned in `packSaved`. With
+//   LORAWAN_RX_STAMP, `rxStampUs` follows the payload.
+//   Returns frame length (excluding the headroom)
+// ─────────────────────────────────────────────────────────────────
+size_t buildLoRaWANUplink(uint8_t *buf, const uint8_t *payload,
+                          size_t payloadLen, uint32_t devAddr,
+                          uint16_t fCnt, bool linkCheck,
+                          uint32_t rxStampUs, uint16_t *packSaved)
+{
+    uint8_t *out = &buf[LW_B0_LEN];
+    size_t pos = 0;
+
+    // MHDR: Unconfirmed Data Up, LoRaWAN R1
+    out[pos++] = 0x40;
+
+    // DevAddr (4 bytes LE)
+    out[pos++] = (uint8_t)(devAddr);
+    out[pos++] = (uint8_t)(devAddr >> 8);
+    out[pos++] = (uint8_t)(devAddr >> 16);
+    out[pos++] = (uint8_t)(devAddr >> 24);
+
+    // FCtrl: no ADR, no ACK, FOptsLen
+    out[pos++] = linkCheck ? 0x01 : 0x00;
+
+    // FCnt (lower 16 bits, LE)
+    out[pos++] = (uint8_t)(fCnt);
+    out[pos++] = (uint8_t)(fCnt >> 8);
+
+    // FOpts: LinkCheckReq has no payload
+    if (linkCheck) out[pos++] = RADIOLIB_LORAWAN_MAC_LINK_CHECK;
+
+    // FPort = 1 (application data), or the packed payload port
+    size_t fPortPos = pos++;
+    out[fPortPos] = 0x01;
+
+    // FRMPayload: packed or plain copy, then encrypt in place
+    size_t frmLen = 0;
+    if (LORAWAN_PACK_PAYLOAD && payloadLen > 1)
+        frmLen = lwPack(payload, payloadLen, &out[pos], payloadLen - 1);
+    if (frmLen) {
+        out[fPortPos] = LORAWAN_PACK_FPORT;
+    } else {
+        memcpy(&out[pos], payload, payloadLen);
+        frmLen = payloadLen;
+    }
+    *packSaved = (uint16_t)(payloadLen - frmLen);
+    if (LORAWAN_RX_STAMP) {
+        out[pos + frmLen++] = (uint8_t)(rxStampUs);
+        out[pos + frmLen++] = (uint8_t)(rxStampUs >> 8);
+        out[pos + frmLen++] = (uint8_t)(rxStampUs >> 16);
+        out[pos + frmLen++] = (uint8_t)(rxStampUs >> 24);
+        out[fPortPos] |= LORAWAN_STAMP_FPORT_BIT;
+    }
+    aes128ctr_lorawan(appSKey, 0, devAddr, (uint32_t)fCnt,
+                      &out[pos], frmLen);
+    pos += frmLen;
+
+    // Append MIC over B0 || MHDR..FRMPayload (Dir = 0, uplink)
+    lorawanMic(buf, pos, 0, devAddr, fCnt, &out[pos]);
+    pos += 4;
+
+    return pos;
+}
@@ -0,0 +1,83 @@
+#include <RadioLib.h>
+#include "lwpack.h"
+#include "textpack.h"
+
+#define LWP_DIST_BITS  9
+#define LWP_LEN_BITS   4
+#define LWP_MIN_MATCH  3
+#define LWP_MAX_MATCH  (LWP_MIN_MATCH + (1 << LWP_LEN_BITS) - 1)
+#define LWP_WINDOW     (1 << LWP_DIST_BITS)
+#define LWP_MATCH_BITS (1 + LWP_DIST_BITS + LWP_LEN_BITS)
+
+// Preset window contents, trained on bench/corpus.txt with
+// `lwpack.py train`. Must match LWPACK_DICT in lwpack.py
+static const char lwpDict[] =
+    " fromgood  radio  switchmeet at N, 8.54 forward minutesentrances"
+    "ensor 3 receiveed at 14:0signal is ing messagewater level the re"
+    "lay is position 47.37latest readingschecking in frommotion detec"
+    "ted tus: ok, uptime temperature  C, humidity  %, battery 3. the ";
+#define LWP_DICT_LEN   (sizeof(lwpDict) - 1)
+
+static_assert(LWP_DICT_LEN + LWPACK_MAX_LEN <= LWP_WINDOW, "dictionary must stay in the window");
+
+// Byte `i` of the dictionary followed by the input
+static inline uint8_t lwpAt(const uint8_t *in, size_t i)
+{
+    return i < LWP_DICT_LEN ? (uint8_t)lwpDict[i] : in[i - LWP_DICT_LEN];
+}
+
+size_t lwPack(const uint8_t *in, size_t len, uint8_t *out, size_t outMax)
+{
+    uint32_t acc = 0;       // pending bits, right-aligned
+    uint8_t  bits = 0;
+    size_t   pos = 0;
+
+    if (len > LWPACK_MAX_LEN) return 0;
+
+    for (size_t p = 0; p < len; ) {
+        // longest match anywhere in the dictionary or the input so far;
+        // a match may run into the bytes it produces
+        size_t cur = LWP_DICT_LEN + p;
+        size_t maxLen = len - p < LWP_MAX_MATCH ? len - p : LWP_MAX_MATCH;
+        size_t best = 0, bestDist = 0;
+        for (size_t j = 0; j < cur && best < maxLen; j++) {
+            if (lwpAt(in, j) != in[p]) continue;
+            size_t k = 1;
+            while (k < maxLen && lwpAt(in, j + k) == in[p + k]) k++;
+            if (k > best) { best = k; bestDist = cur - j; }
+        }
+
+        // take the match only if it beats coding the same bytes as literals
+        uint32_t litBits = 0;
+        for (size_t k = 0; k < best; k++) {
+            uint32_t code;
+            litBits += 1 + textPackCode(in[p + k], &code);
+        }
+
+        if (best >= LWP_MIN_MATCH && litBits > LWP_MATCH_BITS) {
+            acc = (acc << LWP_MATCH_BITS) |
+                  ((uint32_t)(bestDist - 1) << LWP_LEN_BITS) | (best - LWP_MIN_MATCH);
+            bits += LWP_MATCH_BITS;
+            p += best;
+        } else {
+            uint32_t code;
+            uint8_t n = textPackCode(in[p], &code);
+            acc = (acc << (1 + n)) | ((uint32_t)1 << n) | code;
+            bits += 1 + n;
+            p++;
+        }
+
+        // at most 7 + 1 + 21 bits pending, flush whole bytes
+        while (bits >= 8) {
+            if (pos == outMax) return 0;
+            bits -= 8;
+            out[pos++] = (uint8_t)(acc >> bits);
+        }
+    }
+
+    if (bits) {
+        if (pos == outMax) return 0;
+        out[pos++] = (uint8_t)((acc << (8 - bits)) | (0xFF >> bits));
+    }
+    return pos;
+}
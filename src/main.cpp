@@ -4,98 +4,99 @@
 
    Listens on TEMPEST-LoRaWAN settings (915 MHz, BW 500, SF 7).
    When a packet arrives, relays it as a Meshtastic text message
-   (906.875 MHz, BW 250, SF 11, encrypted with the default key).
+   (LongFast 906.875 MHz, BW 250, SF 11, or a faster modem preset
+   for longer texts, encrypted with the default key).
    Then switches back to listening.
 */
 
 #include <RadioLib.h>
 #include <U8g2lib.h>
 #include <Wire.h>
+#include <malloc.h>
 #include "boards.h"
-
-// ── Software AES-128-ECB (tiny-AES, public domain) ──────────────
-// Only the encrypt direction is needed for CTR mode.
-
-static const uint8_t sbox[256] = {
-    0x63,0x7c,0x77,0x7b,0xf2,0x6b,0x6f,0xc5,0x30,0x01,0x67,0x2b,0xfe,0xd7,0xab,0x76,
-    0xca,0x82,0xc9,0x7d,0xfa,0x59,0x47,0xf0,0xad,0xd4,0xa2,0xaf,0x9c,0xa4,0x72,0xc0,
-    0xb7,0xfd,0x93,0x26,0x36,0x3f,0xf7,0xcc,0x34,0xa5,0xe5,0xf1,0x71,0xd8,0x31,0x15,
-    0x04,0xc7,0x23,0xc3,0x18,0x96,0x05,0x9a,0x07,0x12,0x80,0xe2,0xeb,0x27,0xb2,0x75,
-    0x09,0x83,0x2c,0x1a,0x1b,0x6e,0x5a,0xa0,0x52,0x3b,0xd6,0xb3,0x29,0xe3,0x2f,0x84,
-    0x53,0xd1,0x00,0xed,0x20,0xfc,0xb1,0x5b,0x6a,0xcb,0xbe,0x39,0x4a,0x4c,0x58,0xcf,
-    0xd0,0xef,0xaa,0xfb,0x43,0x4d,0x33,0x85,0x45,0xf9,0x02,0x7f,0x50,0x3c,0x9f,0xa8,
-    0x51,0xa3,0x40,0x8f,0x92,0x9d,0x38,0xf5,0xbc,0xb6,0xda,0x21,0x10,0xff,0xf3,0xd2,
-    0xcd,0x0c,0x13,0xec,0x5f,0x97,0x44,0x17,0xc4,0xa7,0x7e,0x3d,0x64,0x5d,0x19,0x73,
-    0x60,0x81,0x4f,0xdc,0x22,0x2a,0x90,0x88,0x46,0xee,0xb8,0x14,0xde,0x5e,0x0b,0xdb,
-    0xe0,0x32,0x3a,0x0a,0x49,0x06,0x24,0x5c,0xc2,0xd3,0xac,0x62,0x91,0x95,0xe4,0x79,
-    0xe7,0xc8,0x37,0x6d,0x8d,0xd5,0x4e,0xa9,0x6c,0x56,0xf4,0xea,0x65,0x7a,0xae,0x08,
-    0xba,0x78,0x25,0x2e,0x1c,0xa6,0xb4,0xc6,0xe8,0xdd,0x74,0x1f,0x4b,0xbd,0x8b,0x8a,
-    0x70,0x3e,0xb5,0x66,0x48,0x03,0xf6,0x0e,0x61,0x35,0x57,0xb9,0x86,0xc1,0x1d,0x9e,
-    0xe1,0xf8,0x98,0x11,0x69,0xd9,0x8e,0x94,0x9b,0x1e,0x87,0xe9,0xce,0x55,0x28,0xdf,
-    0x8c,0xa1,0x89,0x0d,0xbf,0xe6,0x42,0x68,0x41,0x99,0x2d,0x0f,0xb0,0x54,0xbb,0x16
+#include "airtime.h"
+#include "textpack.h"
+#include "lwpack.h"
+#include "rules.h"
+#include "crypto.h"
+#include "frames.h"
+
+// ── Log buffer ──────────────────────────────────────────────────
+// Everything the relay prints goes through Log. The tasks only copy
+// text into this ring; the log task feeds it to USB at low priority,
+// so a slow or stalled host never holds up the radio. Text that does
+// not fit is dropped and counted. Until the tasks start, and in survey
+// mode, Log writes straight to Serial. Writes wake the log task, which
+// otherwise sleeps. In sniffer mode the text is muted and the ring
+// carries binary records instead, each queued whole or not at all.
+#define LOG_BUF_SIZE  4096                      // power of two
+
+class LogBuffer : public Print {
+public:
+    using Print::write;
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *data, size_t len) override;
+    bool   writeRecord(const uint8_t *data, size_t len);
+    size_t drain(uint8_t *out, size_t max);
+
+    bool     buffered = false;
+    bool     muted = false;                     // text is discarded
+    TaskHandle_t reader = NULL;                 // notified of new text
+    uint32_t dropped = 0;                       // bytes
+
+private:
+    size_t   put(const uint8_t *data, size_t len, bool whole);
+
+    uint8_t buf[LOG_BUF_SIZE];
+    size_t  head = 0;                           // free-running
+    size_t  tail = 0;
 };
 
-static const uint8_t Rcon[11] = {
-    0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36
-};
+size_t LogBuffer::write(const uint8_t *data, size_t len)
+{
+    if (muted) return len;
+    if (!buffered) return Serial.write(data, len);
+    put(data, len, false);
+    return len;
+}
 
-static void keyExpansion(const uint8_t key[16], uint8_t roundKeys[176])
-{
-    memcpy(roundKeys, key, 16);
-    for (int i = 4; i < 44; i++) {
-        uint8_t tmp[4];
-        memcpy(tmp, &roundKeys[(i - 1) * 4], 4);
-        if (i % 4 == 0) {
-            uint8_t t = tmp[0];
-            tmp[0] = sbox[tmp[1]] ^ Rcon[i / 4];
-            tmp[1] = sbox[tmp[2]];
-            tmp[2] = sbox[tmp[3]];
-            tmp[3] = sbox[t];
-        }
-        for (int j = 0; j < 4; j++)
-            roundKeys[i * 4 + j] = roundKeys[(i - 4) * 4 + j] ^ tmp[j];
-    }
-}
-
-static uint8_t xtime(uint8_t x) { return (x << 1) ^ ((x >> 7) * 0x1b); }
-
-static void aes128_ecb_encrypt(const uint8_t key[16], const uint8_t in[16], uint8_t out[16])
-{
-    uint8_t state[16], rk[176];
-    keyExpansion(key, rk);
-    memcpy(state, in, 16);
-
-    // AddRoundKey 0
-    for (int i = 0; i < 16; i++) state[i] ^= rk[i];
-
-    for (int round = 1; round <= 10; round++) {
-        // SubBytes
-        for (int i = 0; i < 16; i++) state[i] = sbox[state[i]];
-        // ShiftRows
-        uint8_t t;
-        t = state[1]; state[1]=state[5]; state[5]=state[9]; state[9]=state[13]; state[13]=t;
-        t = state[2]; state[2]=state[10]; state[10]=t; t=state[6]; state[6]=state[14]; state[14]=t;
-        t = state[15]; state[15]=state[11]; state[11]=state[7]; state[7]=state[3]; state[3]=t;
-        // MixColumns (skip on last round)
-        if (round < 10) {
-            for (int c = 0; c < 4; c++) {
-                int i = c * 4;
-                uint8_t a0=state[i], a1=state[i+1], a2=state[i+2], a3=state[i+3];
-                uint8_t x0=xtime(a0), x1=xtime(a1), x2=xtime(a2), x3=xtime(a3);
-                state[i]   = x0 ^ x1 ^ a1 ^ a2 ^ a3;
-                state[i+1] = a0 ^ x1 ^ x2 ^ a2 ^ a3;
-                state[i+2] = a0 ^ a1 ^ x2 ^ x3 ^ a3;
-                state[i+3] = x0 ^ a0 ^ a1 ^ a2 ^ x3;
-            }
-        }
-        // AddRoundKey
-        for (int i = 0; i < 16; i++) state[i] ^= rk[round * 16 + i];
-    }
-    memcpy(out, state, 16);
+bool LogBuffer::writeRecord(const uint8_t *data, size_t len)
+{
+    if (!buffered) return Serial.write(data, len) == len;
+    return put(data, len, true) == len;
 }
 
+size_t LogBuffer::put(const uint8_t *data, size_t len, bool whole)
+{
+    // several tasks print; a short critical section keeps each
+    // print() call's bytes together
+    taskENTER_CRITICAL();
+    size_t n = LOG_BUF_SIZE - (head - tail);
+    if (n > len) n = len;
+    else if (n < len && whole) n = 0;
+    for (size_t i = 0; i < n; i++) buf[(head + i) % LOG_BUF_SIZE] = data[i];
+    head += n;
+    dropped += len - n;
+    taskEXIT_CRITICAL();
+    if (n && reader) xTaskNotifyGive(reader);
+    return n;
+}
+
+size_t LogBuffer::drain(uint8_t *out, size_t max)
+{
+    taskENTER_CRITICAL();
+    size_t n = head - tail;
+    if (n > max) n = max;
+    for (size_t i = 0; i < n; i++) out[i] = buf[(tail + i) % LOG_BUF_SIZE];
+    tail += n;
+    taskEXIT_CRITICAL();
+    return n;
+}
+
+static LogBuffer Log;
+
 // ── Meshtastic default encryption key ───────────────────────────
-static const uint8_t meshKey[16] = {
+static constexpr uint8_t meshKey[16] = {
     0xd4, 0xf1, 0xbb, 0x3a, 0x20, 0x29, 0x07, 0x59,
     0xf0, 0xbc, 0xff, 0xab, 0xcf, 0x4e, 0x69, 0x01
 };
@@ -103,18 +104,204 @@ static const uint8_t meshKey[16] = {
 // ── Meshtastic header constants ─────────────────────────────────
 static const uint32_t MESH_BROADCAST = 0xFFFFFFFF;
 static const uint8_t  MESH_FLAGS     = 0x63;       // hop_start=3, hop_limit=3
-static const uint8_t  MESH_CHANNEL   = 0x08;       // XOR("LongFast") ^ XOR(defaultPSK)
 
-// ── LoRaWAN ABP credentials & channel plan ──────────────────────
-static const uint8_t nwkSKey[16] = LORAWAN_NWK_SKEY;
-static const uint8_t appSKey[16] = LORAWAN_APP_SKEY;
+// ── Meshtastic modem presets ────────────────────────────────────
+// The default channel of each preset is named after it, which fixes
+// both its frequency slot (djb2(name) % channels across the US band)
+// and the header channel hash (XOR(name) ^ XOR(PSK)). Both are
+// computed at compile time, as are the per-preset time-on-air tables.
+#define MESH_FREQ_START   902.0f
+#define MESH_FREQ_END     928.0f
+
+static constexpr uint32_t meshDjb2(const char *s, uint32_t h = 5381)
+{
+    return *s ? meshDjb2(s + 1, h * 33 + (uint8_t)*s) : h;
+}
+
+static constexpr uint8_t meshXorName(const char *s)
+{
+    return *s ? (uint8_t)(*s ^ meshXorName(s + 1)) : 0;
+}
+
+static constexpr uint8_t meshXorKey(size_t i = 0)
+{
+    return i < sizeof(meshKey) ? (uint8_t)(meshKey[i] ^ meshXorKey(i + 1)) : 0;
+}
+
+static constexpr float meshSlotFreq(const char *name, uint16_t bwKhz)
+{
+    return MESH_FREQ_START + bwKhz / 2000.0f +
+           (meshDjb2(name) % (uint32_t)((MESH_FREQ_END - MESH_FREQ_START) * 1000 / bwKhz)) *
+           (bwKhz / 1000.0f);
+}
+
+enum {
+    MESH_SHORT_TURBO = 0,
+    MESH_SHORT_FAST,
+    MESH_SHORT_SLOW,
+    MESH_MEDIUM_FAST,
+    MESH_MEDIUM_SLOW,
+    MESH_LONG_FAST,
+    MESH_LONG_MODERATE,
+    MESH_LONG_SLOW,
+    MESH_PRESET_COUNT
+};
+
+struct MeshPreset {
+    const char *name;
+    uint16_t bwKhz;
+    uint8_t  sf;
+    uint8_t  cr;
+    float    freq;                      // MHz
+    uint8_t  hash;                      // header channel hash
+    uint32_t (*toaUs)(size_t len);      // 16 symbol preamble, CRC off
+};
+
+#define MESH_PRESET(name, bw, sf, cr) \
+    { name, bw, sf, cr, meshSlotFreq(name, bw), \
+      (uint8_t)(meshXorName(name) ^ meshXorKey()), &LoRaToa<sf, bw, cr, 16, false>::us }
+
+static const MeshPreset meshPresets[MESH_PRESET_COUNT] = {
+    MESH_PRESET("ShortTurbo", 500,  7, 5),
+    MESH_PRESET("ShortFast",  250,  7, 5),
+    MESH_PRESET("ShortSlow",  250,  8, 5),
+    MESH_PRESET("MediumFast", 250,  9, 5),
+    MESH_PRESET("MediumSlow", 250, 10, 5),
+    MESH_PRESET("LongFast",   250, 11, 5),
+    MESH_PRESET("LongMod",    125, 11, 8),
+    MESH_PRESET("LongSlow",   125, 12, 8),
+};
+
+static_assert(meshSlotFreq("LongFast", 250) == 906.875f, "LongFast slot");
+static_assert((meshXorName("LongFast") ^ meshXorKey()) == 0x08, "LongFast hash");
+
+// Presets the relay may use, in policy order (boards.h)
+static const uint8_t meshEnabled[] = MESH_PRESETS;
+#define MESH_ENABLED_COUNT (sizeof(meshEnabled) / sizeof(meshEnabled[0]))
+
+struct MeshPresetStats {
+    uint32_t sent;
+    uint32_t failed;
+    uint32_t airtimeMs;                 // TX time spent on this preset
+    uint8_t  busyQ8;                    // channel busy ratio, x/256
+};
+static MeshPresetStats meshStats[MESH_PRESET_COUNT];
+static uint32_t meshPackedFrames = 0;   // sent packed, and bytes saved
+static uint32_t meshPackedBytes = 0;
+
+// ── LoRaWAN ABP session & channel plan ──────────────────────────
+// NwkSKey / AppSKey are in frames.cpp
 static uint16_t lorawanFCnt = 0;
 
 // US915 sub-band 2 (channels 8-15)
-static const float lorawanFreqs[8] = {
+#define LW_CH_COUNT  8
+static const float lorawanFreqs[LW_CH_COUNT] = {
     903.9, 904.1, 904.3, 904.5, 904.7, 904.9, 905.1, 905.3
 };
-static uint8_t lorawanChIdx = 0;
+
+// Channel 65 (904.6 MHz) is the 500 kHz channel inside sub-band 2:
+// DR4 (SF8/BW500) uses it directly, LR-FHSS DR5 / DR6 hop across it
+static const float lorawanWideFreq = 904.6;
+
+#if LORAWAN_UPLINK_DR == 5 || LORAWAN_UPLINK_DR == 6
+#define LORAWAN_UPLINK_LRFHSS 1
+#else
+#define LORAWAN_UPLINK_LRFHSS 0
+#endif
+#define LORAWAN_FHSS_CR  ((LORAWAN_UPLINK_DR == 5) ? RADIOLIB_SX126X_LR_FHSS_CR_1_3 \
+                                                   : RADIOLIB_SX126X_LR_FHSS_CR_2_3)
+#define LORAWAN_FHSS_HDR ((LORAWAN_UPLINK_DR == 5) ? 3 : 2)
+static const uint8_t lorawanFhssSyncWord[4] = { 0x2C, 0x0F, 0x79, 0x95 };
+
+// ── LoRaWAN link margin ─────────────────────────────────────────
+// Every LORAWAN_LINKCHECK_EVERY uplinks carry a LinkCheckReq, and the
+// LinkCheckAns margin (dB above the gateway's demodulation floor) is
+// kept as seen at DR3. DR4 needs about 4 dB more SNR than DR3: +6 dB
+// for 4x the noise bandwidth, -2.5 dB for the extra SF step. With no
+// answer to two requests in a row the margin is forgotten and LoRa
+// uplinks fall back to DR3.
+#define LW_DR4_PENALTY_DB     4
+#define LW_MARGIN_UNKNOWN     (-1)
+#define LW_LINKCHECK_MAX_MISS 2
+static int16_t  lorawanMargin = LW_MARGIN_UNKNOWN;   // dB, at DR3
+static uint8_t  lorawanGwCnt = 0;
+static uint8_t  lorawanLinkCheckDue = 0;    // uplinks until the next request
+static uint8_t  lorawanLinkCheckMissed = 0;
+static uint32_t lorawanDrSent[2];           // uplinks sent at DR3 / DR4
+static uint32_t lorawanSavedUs = 0;         // airtime saved vs all at DR3
+static uint32_t lorawanPackedFrames = 0;    // sent packed, and bytes saved
+static uint32_t lorawanPackedBytes = 0;
+
+// ── LoRaWAN channel quality ─────────────────────────────────────
+// Each 125 kHz channel keeps a penalty (0 = clean, 255 = unusable):
+// busy CADs, failed TX and unanswered LinkCheckReqs push it up, clean
+// TX and LinkCheckAns pull it back down. Each DR3 uplink picks its
+// channel at random, weighted by 256 - penalty, never the previous
+// one, so usage stays pseudo-random as US915 requires. A channel whose
+// penalty reaches LW_CH_BLOCK_AT sits out LW_CH_BLOCK_MS, but at most
+// half the sub-band is ever blacklisted.
+#define LW_CH_BLOCK_AT     192
+#define LW_CH_BLOCK_MS     60000UL
+#define LW_CH_MAX_BLOCKED  (LW_CH_COUNT / 2)
+
+enum { LW_CH_CLEAR = 0, LW_CH_BUSY, LW_CH_FAILED, LW_CH_ACK, LW_CH_NO_ACK };
+
+struct LwChannel {
+    uint8_t  penalty;
+    bool     blocked;
+    uint32_t blockedUntil;              // millis()
+    uint32_t used;
+    uint32_t busy;
+    uint32_t failed;
+    uint32_t acked;
+};
+
+static LwChannel lorawanCh[LW_CH_COUNT];
+static int8_t lorawanLastCh = -1;
+
+// ── TEMPEST frequency tracking ──────────────────────────────────
+// Every good TEMPEST packet reports its carrier offset from where RX
+// is tuned (positive = carrier above). Added to the tuning that gives
+// the emitter's offset from LoRa_frequency, smoothed by a moving
+// average (alpha 1/8, seeded by the first packet). Once the estimate
+// is TEMPEST_AFC_STEP_HZ away from the tuning, RX follows it, so weak
+// packets are not demodulated off-centre. The last AFC_HISTORY raw
+// offsets are logged with each retune.
+#define AFC_MIN_PACKETS  4          // before the first retune
+#define AFC_HISTORY      8
+static int32_t  tempestTuneHz = 0;          // RX tuning vs LoRa_frequency
+static int32_t  tempestOffsetHz = 0;        // filtered emitter offset
+static uint32_t tempestAfcPackets = 0;
+static uint32_t tempestRetunes = 0;
+static int32_t  tempestAfcHist[AFC_HISTORY];
+
+// ── TEMPEST RX gain ─────────────────────────────────────────────
+// Inputs of the boosted-gain decision: the SNR margin of good packets
+// over the SF7 demodulation floor (moving average, 1/8), a score of
+// CRC errors received within RX_BOOST_MARGIN_DB of that floor, and the
+// noise floor: the quietest of RX_NOISE_WINDOW instantaneous RSSI
+// reads taken between packets, averaged (1/4) over windows so packets
+// in the air don't count as noise.
+#define RX_SNR_FLOOR_Q4      (-120)     // SF7: -7.5 dB, in 1/16 dB
+#define RX_BOOST_HYST_DB     3          // extra margin before saving again
+#define RX_CRC_SCORE_STEP    64
+#define RX_CRC_SCORE_BOOST   128        // about two recent near misses
+#define RX_NOISE_EVERY_MS    250
+#define RX_NOISE_WINDOW      8
+#define RX_NOISE_UNKNOWN     INT16_MIN
+
+static bool     rxBoosted = RX_BOOST_GAIN == 2;
+static int8_t   rxGainApplied = -1;             // mode in the radio, -1 = unknown
+static int16_t  rxMarginQ4 = INT16_MIN;         // 1/16 dB, INT16_MIN = no packet yet
+static uint8_t  rxCrcScore = 0;
+static int16_t  rxNoiseDbm = RX_NOISE_UNKNOWN;
+static int16_t  rxNoiseMin = 0;
+static uint8_t  rxNoiseCount = 0;
+static uint32_t rxNoiseMillis = 0;
+static uint32_t rxGainSince = 0;                // millis() of the last switch
+static uint32_t rxGainMs[2];                    // time power saving / boosted
+static uint32_t rxGainOk[2];                    // good packets per mode
+static uint32_t rxGainCrc[2];                   // CRC errors per mode
 
 // ── Radio object ────────────────────────────────────────────────
 SX1262 radio = new Module(RADIO_CS_PIN, RADIO_DIO1_PIN, RADIO_RST_PIN, RADIO_BUSY_PIN);
@@ -123,121 +310,369 @@ SX1262 radio = new Module(RADIO_CS_PIN, RADIO_DIO1_PIN, RADIO_RST_PIN, RADIO_BUS
 U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, /* reset=*/ U8X8_PIN_NONE);
 static uint32_t relayCount = 0;
 
-static void displayStatus(const char *line1, const char *line2,
-                           const char *line3, const char *line4)
+// Four lines of status text. Once the tasks run, displayStatus() only
+// leaves the latest text in a one-entry mailbox and the display task
+// does the I2C transfer, so a redraw never delays RX or TX
+struct DisplayMsg {
+    char line[4][22];
+};
+
+static QueueHandle_t displayQueue = NULL;
+static bool     displayOn = true;
+static uint32_t displayOnSince = 0;             // millis()
+static uint32_t displayOnMs = 0;                // finished on spans
+
+static void displayDraw(const DisplayMsg &m)
 {
     u8g2.clearBuffer();
     u8g2.setFont(u8g2_font_6x10_tf);
-    if (line1) u8g2.drawStr(8,  14, line1);
-    if (line2) u8g2.drawStr(8,  28, line2);
-    if (line3) u8g2.drawStr(8,  42, line3);
-    if (line4) u8g2.drawStr(8,  56, line4);
+    for (uint8_t i = 0; i < 4; i++)
+        if (m.line[i][0]) u8g2.drawStr(8, 14 + 14 * i, m.line[i]);
     u8g2.sendBuffer();
 }
 
+static void displayStatus(const char *line1, const char *line2,
+                           const char *line3, const char *line4)
+{
+    const char *lines[4] = { line1, line2, line3, line4 };
+    DisplayMsg m;
+    for (uint8_t i = 0; i < 4; i++)
+        snprintf(m.line[i], sizeof(m.line[i]), "%s", lines[i] ? lines[i] : "");
+
+    if (displayQueue) xQueueOverwrite(displayQueue, &m);
+    else displayDraw(m);
+}
+
+// ── Spectrum survey ─────────────────────────────────────────────
+// One byte of level per step, 0.5 dB above -127.5 dBm (255 minus the
+// raw GetRssiInst value): the highest level ever seen, and a moving
+// average (alpha 1/8 per sweep) in Q8. 902-928 MHz at 125 kHz steps
+// takes 627 bytes
+#define SURVEY_BINS  ((SURVEY_STOP_KHZ - SURVEY_START_KHZ) / SURVEY_STEP_KHZ + 1)
+static uint8_t  surveyMax[SURVEY_BINS];
+static uint16_t surveyAvg[SURVEY_BINS];
+static uint32_t surveySweeps = 0;
+static uint32_t surveySteps = 0;            // since the last report
+static uint32_t surveyReportMillis = 0;
+
 // ── Interrupt flag ──────────────────────────────────────────────
+// DIO1 also wakes the radio task, which sleeps until the flag is set
+// or the framing task hands it a frame. With enableInterrupt off the
+// task is driving the radio itself and only the wakeup counts
 volatile bool receivedFlag = false;
 volatile bool enableInterrupt = true;
+static TaskHandle_t radioTaskHandle = NULL;
+
+// ── Hardware RX timestamps ──────────────────────────────────────
+// RX_STAMP_TIMER counts µs from boot. DIO1's rising edge captures it
+// into CC[0] through PPI, so a frame is stamped the moment the radio
+// raises RxDone, free of ISR and task latency; CC[1] is for reading
+// the current time. Without a GPIOTE channel on DIO1 to hook, the ISR
+// captures instead. Wraps every 71.6 minutes.
+static bool rxStampHw = false;
 
 void setFlag(void)
 {
-    if (!enableInterrupt) return;
-    receivedFlag = true;
+    if (!rxStampHw) RX_STAMP_TIMER->TASKS_CAPTURE[0] = 1;
+    if (enableInterrupt) receivedFlag = true;
+    if (!radioTaskHandle) return;
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(radioTaskHandle, &woken);
+    portYIELD_FROM_ISR(woken);
 }
 
+// ── Relay rule counters ─────────────────────────────────────────
+// Frames per rule, then those that matched none
+static uint32_t ruleHits[RELAY_RULE_COUNT + 1];
+static uint32_t ruleDropped = 0;
+
 // ── Packet ID counter (incrementing) ────────────────────────────
 static uint32_t packetIdCounter = 1;
 
-// ─────────────────────────────────────────────────────────────────
-// AES-128-CTR encrypt in-place
-//   nonce: [packetId:8LE][fromNode:4LE][0x00:4]
-//   Uses software AES-128-ECB (SoftDevice ECB unreliable)
-// ─────────────────────────────────────────────────────────────────
-static void aes128ctr_encrypt(const uint8_t key[16], uint32_t packetId,
-                              uint32_t fromNode, uint8_t *data, size_t len)
+// ── Relay frame pool ────────────────────────────────────────────
+// Each received frame lives in one slot from RxDone until both uplinks
+// are sent. The TEMPEST payload is read straight into `rx`, and the
+// LoRaWAN / Meshtastic frames are built and encrypted in place, so no
+// per-packet stack buffers are needed.
+#define RELAY_POOL_SIZE   4
+#define RX_MAX_LEN        255
+#define LW_MAX_LEN        (9 + RX_MAX_LEN + LW_STAMP_LEN + 4)  // MHDR..FPort, FRMPayload, MIC
+#define MESH_HDR_LEN      16
+#define MESH_MAX_LEN      (MESH_HDR_LEN + 6 + RX_MAX_LEN)
+
+// SX1262 256-byte data buffer split: TEMPEST RX lands in the low
+// region, the next uplink is preloaded into the high region. The
+// radio writes a received packet from RX_BASE whatever its length, so
+// one longer than RADIO_BUF_RX_MAX runs over a preloaded uplink; the
+// RX path drops the preload then (preloadRxLanded())
+#define RADIO_BUF_RX_BASE 0x00
+#define RADIO_BUF_TX_BASE 0x80
+#define RADIO_BUF_RX_MAX  (RADIO_BUF_TX_BASE - RADIO_BUF_RX_BASE)
+
+// Output queues, one per uplink; see "Output scheduler" below
+enum { TXQ_LORAWAN = 0, TXQ_MESH, TXQ_COUNT };
+
+// `pending` bit of a slot handed to the framing task; it can't be
+// reused until the built frame comes back to the radio task
+#define FRAME_IN_FLIGHT   (1 << TXQ_COUNT)
+
+struct RelayFrame {
+    SX126x::PacketInfo_t info;          // captured once at RxDone
+    uint32_t rxMillis;                  // RxDone time, queue ages count from here
+    uint32_t rxStampUs;                 // RxDone edge, captured by hardware
+    uint8_t pending;                    // bit per TXQ_* still holding this slot
+    uint8_t route;                      // ROUTE_* picked by the relay rules
+    uint32_t toaUs[TXQ_COUNT];          // time on air of each uplink
+    size_t  rxLen;
+    uint8_t rx[RX_MAX_LEN + 1];         // +1 keeps room for a terminator
+    size_t  lwLen;
+    uint16_t lwFCnt;
+    uint8_t lwDr;                       // US915 data rate of the uplink
+    uint16_t lwPackSaved;               // bytes saved by packing, 0 = plain
+    bool    lwLinkCheck;                // LinkCheckReq in FOpts
+    uint8_t lw[LW_B0_LEN + LW_MAX_LEN]; // B0 block, then PHYPayload
+    size_t  meshLen;
+    uint32_t meshId;
+    uint8_t meshPreset;                 // MESH_* modem preset
+    uint16_t meshPackSaved;             // bytes saved by packing, 0 = plain text
+    uint8_t mesh[MESH_MAX_LEN];         // header, then encrypted Data
+};
+
+static RelayFrame framePool[RELAY_POOL_SIZE];
+static uint8_t framePoolHead = 0;
+
+// Slot indices, radio task → framing task and back; each holds the
+// whole pool so a send never has to wait
+static QueueHandle_t frameQueue = NULL;
+static QueueHandle_t builtQueue = NULL;
+
+static void txqEvict(RelayFrame *f);
+
+static RelayFrame *acquireFrame()
 {
-    // Build initial nonce (16 bytes)
-    uint8_t nonce[16];
-    memset(nonce, 0, sizeof(nonce));
-    // packetId as 8-byte LE (upper 4 bytes stay zero)
-    nonce[0] = (uint8_t)(packetId);
-    nonce[1] = (uint8_t)(packetId >> 8);
-    nonce[2] = (uint8_t)(packetId >> 16);
-    nonce[3] = (uint8_t)(packetId >> 24);
-    // fromNode as 4-byte LE at offset 8
-    nonce[8]  = (uint8_t)(fromNode);
-    nonce[9]  = (uint8_t)(fromNode >> 8);
-    nonce[10] = (uint8_t)(fromNode >> 16);
-    nonce[11] = (uint8_t)(fromNode >> 24);
-    // bytes 4-7 and 12-15 are zero
+    // the ring head is the oldest slot; if its uplinks are still
+    // queued when a new packet arrives, they are dropped. A slot
+    // still being built can't be taken, the packet is lost instead
+    RelayFrame *f = &framePool[framePoolHead];
+    if (f->pending & FRAME_IN_FLIGHT) return NULL;
+    framePoolHead = (framePoolHead + 1) % RELAY_POOL_SIZE;
+    if (f->pending) txqEvict(f);
+    f->rxLen = f->lwLen = f->meshLen = 0;
+    return f;
+}
 
-    uint8_t keystream[16];
-    size_t offset = 0;
-    while (offset < len) {
-        // Encrypt nonce → keystream block
-        aes128_ecb_encrypt(key, nonce, keystream);
+// ── Output scheduler ────────────────────────────────────────────
+// Every received frame is queued once per uplink. The queue heads
+// compete for the radio: lower priority value first, then shorter
+// time on air, so a short LoRaWAN uplink never waits behind an SF11
+// Meshtastic frame. One frame is sent per radio task pass and RX resumes
+// in between. A frame that would finish TX later than its queue's
+// max age after RxDone is dropped instead of being sent late.
+//
+// Each queue also owns a token bucket of airtime (µs), refilled at
+// its hourly budget up to the burst size. A head whose time on air
+// exceeds the tokens left waits; once it fits, frames that piled up
+// behind it are merged into the same uplink while the text and the
+// budget allow.
+//
+// With listen before talk the head also waits out a random contention
+// window and a clear CAD; the radio is back in TEMPEST RX meanwhile.
+struct TxQueue {
+    const char *name;
+    uint8_t  priority;                  // lower is sent first
+    uint32_t maxAgeMs;                  // RxDone → end of TX deadline
+    uint32_t budgetMsPerHour;           // bucket refill rate
+    uint32_t burstMs;                   // bucket depth
+    size_t   maxText;                   // longest (merged) payload
+    bool     lbt;                       // CAD before TX
+    uint32_t tokensUs;
+    uint32_t refillMillis;
+    int8_t   deferredSlot;              // head already reported as deferred
+    int8_t   lbtSlot;                   // head whose contention window is running
+    uint8_t  lbtTries;                  // busy CADs of that head
+    uint32_t lbtUntil;                  // millis() the window ends
+    uint8_t  slot[RELAY_POOL_SIZE];     // frame pool indices, oldest first
+    uint8_t  head;
+    uint8_t  count;
+    uint32_t sent;
+    uint32_t dropped;
+    uint32_t failed;
+    uint32_t deferred;
+    uint32_t coalesced;
+    uint32_t latencySumMs;              // RxDone → TX done, sent frames only
+    uint32_t latencyMaxMs;
+    uint32_t cadClear;
+    uint32_t cadBusy;
+    uint32_t cadGaveUp;                 // dropped after LBT_MAX_TRIES
+    uint32_t backoffMs;                 // contention windows waited
+};
 
-        // XOR keystream with data
-        size_t blockLen = (len - offset < 16) ? (len - offset) : 16;
-        for (size_t i = 0; i < blockLen; i++) {
-            data[offset + i] ^= keystream[i];
-        }
-        offset += blockLen;
+// Largest FRMPayload of the uplink DR (US915 N, no FOpts). At DR3 it
+// also keeps the uplink under the 400 ms dwell time, and DR4 carries
+// the same. Meshtastic text is capped at its own DATA_PAYLOAD_LEN.
+#if LORAWAN_UPLINK_DR == 5
+#define LORAWAN_MAX_TEXT  (50 - LW_STAMP_LEN)
+#elif LORAWAN_UPLINK_DR == 6
+#define LORAWAN_MAX_TEXT  (125 - LW_STAMP_LEN)
+#else
+#define LORAWAN_MAX_TEXT  (222 - LW_STAMP_LEN)
+#endif
+#define MESH_MAX_TEXT     233
+
+// US915 dwell time limit on the 125 kHz LoRa channels
+#define LORAWAN_DWELL_US  400000UL
+
+static TxQueue txQueues[TXQ_COUNT] = {
+    { "LoRaWAN",    0, 10000, LORAWAN_AIRTIME_MS_PER_HOUR, LORAWAN_AIRTIME_BURST_MS, LORAWAN_MAX_TEXT,
+      LORAWAN_LBT && !LORAWAN_UPLINK_LRFHSS },
+    { "Meshtastic", 1, 30000, MESH_AIRTIME_MS_PER_HOUR,    MESH_AIRTIME_BURST_MS,    MESH_MAX_TEXT,
+      MESH_LBT },
+};
 
-        // Increment nonce (big-endian over full 128 bits)
-        for (int i = 15; i >= 0; i--) {
-            if (++nonce[i] != 0) break;
-        }
+static void txqBudgetInit()
+{
+    for (uint8_t q = 0; q < TXQ_COUNT; q++) {
+        txQueues[q].tokensUs = txQueues[q].burstMs * 1000UL;
+        txQueues[q].refillMillis = millis();
+        txQueues[q].deferredSlot = -1;
+        txQueues[q].lbtSlot = -1;
     }
 }
 
-// ─────────────────────────────────────────────────────────────────
-// Encode a Meshtastic Data protobuf
-//   field 1 = portnum (varint)
-//   field 2 = payload (length-delimited)
-//   Returns total encoded length
-// ─────────────────────────────────────────────────────────────────
-static size_t encodeDataProtobuf(uint8_t *out, uint32_t portnum,
-                                 const uint8_t *payload, size_t payloadLen)
+static void txqRefill(uint8_t q, uint32_t now)
 {
-    size_t pos = 0;
+    TxQueue &tq = txQueues[q];
+    uint32_t elapsed = now - tq.refillMillis;
+    // budgetMsPerHour / 3600 is the refill in µs per ms elapsed
+    uint64_t add = (uint64_t)elapsed * tq.budgetMsPerHour / 3600;
+    if (!add) return;  // keep accumulating elapsed time
+    uint64_t tokens = tq.tokensUs + add;
+    uint32_t depth = tq.burstMs * 1000UL;
+    tq.tokensUs = tokens > depth ? depth : (uint32_t)tokens;
+    tq.refillMillis = now;
+}
 
-    // field 1, wire type 0 (varint): tag = 0x08
-    out[pos++] = 0x08;
-    // encode portnum as varint
-    uint32_t v = portnum;
-    while (v >= 0x80) {
-        out[pos++] = (uint8_t)(v | 0x80);
-        v >>= 7;
-    }
-    out[pos++] = (uint8_t)v;
+// Remaining budget in percent of the burst size
+static unsigned txqBudgetPct(uint8_t q)
+{
+    return (unsigned)((uint64_t)txQueues[q].tokensUs * 100 /
+                      (txQueues[q].burstMs * 1000UL));
+}
+
+static void budgetLine(char *buf, size_t size, const char *prefix)
+{
+    snprintf(buf, size, "%sLW%3u%% MT%3u%%", prefix,
+             txqBudgetPct(TXQ_LORAWAN), txqBudgetPct(TXQ_MESH));
+}
+
+static RelayFrame *txqHead(uint8_t q)
+{
+    return &framePool[txQueues[q].slot[txQueues[q].head]];
+}
+
+static bool txqPending()
+{
+    for (uint8_t q = 0; q < TXQ_COUNT; q++)
+        if (txQueues[q].count) return true;
+    return false;
+}
+
+static void txqPush(uint8_t q, RelayFrame *f)
+{
+    // a slot is in each queue at most once, so this can't overflow
+    TxQueue &tq = txQueues[q];
+    tq.slot[(tq.head + tq.count) % RELAY_POOL_SIZE] = (uint8_t)(f - framePool);
+    tq.count++;
+    f->pending |= (1 << q);
+}
 
-    // field 2, wire type 2 (length-delimited): tag = 0x12
-    out[pos++] = 0x12;
-    // encode length as varint
-    v = (uint32_t)payloadLen;
-    while (v >= 0x80) {
-        out[pos++] = (uint8_t)(v | 0x80);
-        v >>= 7;
+static void txqPop(uint8_t q)
+{
+    TxQueue &tq = txQueues[q];
+    txqHead(q)->pending &= ~(1 << q);
+    tq.head = (tq.head + 1) % RELAY_POOL_SIZE;
+    tq.count--;
+    tq.deferredSlot = -1;
+    tq.lbtSlot = -1;
+}
+
+static void txqDrop(uint8_t q, const __FlashStringHelper *why)
+{
+    txQueues[q].dropped++;
+    if (Serial) {
+        Log.print(F("[Sched] Dropped "));
+        Log.print(txQueues[q].name);
+        Log.print(F(" frame ("));
+        Log.print(why);
+        Log.println(F(")"));
     }
-    out[pos++] = (uint8_t)v;
+    txqPop(q);
+}
 
-    // copy payload
-    memcpy(&out[pos], payload, payloadLen);
-    pos += payloadLen;
+// Frames enter both queues in RX order, so the slot being reused is
+// the oldest one and sits at the head of every queue still holding it
+static void txqEvict(RelayFrame *f)
+{
+    for (uint8_t q = 0; q < TXQ_COUNT; q++)
+        if (f->pending & (1 << q)) txqDrop(q, F("pool full"));
+}
 
-    return pos;
+static void printTxqStats()
+{
+    if (!Serial) return;
+    for (uint8_t q = 0; q < TXQ_COUNT; q++) {
+        const TxQueue &tq = txQueues[q];
+        Log.print(F("[Sched] "));
+        Log.print(tq.name);
+        Log.print(F(": queued="));
+        Log.print(tq.count);
+        Log.print(F(" sent="));
+        Log.print(tq.sent);
+        Log.print(F(" dropped="));
+        Log.print(tq.dropped);
+        Log.print(F(" failed="));
+        Log.print(tq.failed);
+        Log.print(F(" deferred="));
+        Log.print(tq.deferred);
+        Log.print(F(" merged="));
+        Log.print(tq.coalesced);
+        Log.print(F(" budget="));
+        Log.print(tq.tokensUs / 1000);
+        Log.print('/');
+        Log.print(tq.burstMs);
+        Log.print(F(" ms"));
+        Log.print(F(" latency avg/max="));
+        Log.print(tq.sent ? tq.latencySumMs / tq.sent : 0);
+        Log.print('/');
+        Log.print(tq.latencyMaxMs);
+        Log.print(F(" ms"));
+        if (tq.lbt) {
+            Log.print(F(" cad clear/busy="));
+            Log.print(tq.cadClear);
+            Log.print('/');
+            Log.print(tq.cadBusy);
+            Log.print(F(" gave up="));
+            Log.print(tq.cadGaveUp);
+            Log.print(F(" backoff="));
+            Log.print(tq.backoffMs);
+            Log.print(F(" ms"));
+        }
+        Log.println();
+    }
 }
 
 // ─────────────────────────────────────────────────────────────────
-// Configure radio for Meshtastic TX (906.875 MHz, BW 250, SF 11)
+// Configure radio for Meshtastic TX on a modem preset
+//   (LongFast: 906.875 MHz, BW 250, SF 11)
 // ─────────────────────────────────────────────────────────────────
-static void configMeshtastic()
+static void configMeshtastic(uint8_t preset)
 {
-    radio.setFrequency(906.875);
-    radio.setBandwidth(250);
-    radio.setSpreadingFactor(11);
-    radio.setCodingRate(5);
+    const MeshPreset &mp = meshPresets[preset];
+    radio.setFrequency(mp.freq);
+    radio.setBandwidth(mp.bwKhz);
+    radio.setSpreadingFactor(mp.sf);
+    radio.setCodingRate(mp.cr);
     radio.setPreambleLength(16);
     radio.setSyncWord(0x2B);
     radio.setCRC(0);            // Meshtastic disables LoRa-level CRC
@@ -245,204 +680,228 @@ static void configMeshtastic()
 }
 
 // ─────────────────────────────────────────────────────────────────
-// Configure radio for TEMPEST-LoRaWAN RX (915 MHz, BW 500, SF 7)
+// Uplink frame length for a given text length
 // ─────────────────────────────────────────────────────────────────
-static void configTempest()
+static size_t uplinkLen(uint8_t q, size_t textLen)
 {
-    radio.setFrequency(LoRa_frequency);  // 915.0
-    radio.setBandwidth(500);
-    radio.setSpreadingFactor(7);
-    radio.setCodingRate(5);
-    radio.setPreambleLength(8);
-    radio.setSyncWord(RADIOLIB_SX126X_SYNC_WORD_PRIVATE);
-    radio.setCRC(2);
+    if (q == TXQ_LORAWAN) return 9 + textLen + LW_STAMP_LEN + 4;  // MHDR..FPort, MIC
+    // header, portnum field, payload tag + length varint
+    return MESH_HDR_LEN + 2 + 1 + (textLen > 127 ? 2 : 1) + textLen;
 }
 
 // ─────────────────────────────────────────────────────────────────
-// AES-128-CTR for LoRaWAN payload encryption
-//   Ai = 0x01 | 0x00 0x00 0x00 0x00 | Dir | DevAddr(4 LE) | FCnt(4 LE) | 0x00 | i
+// Pick the Meshtastic preset for a `len` byte packet
+//   First enabled preset whose time on air fits the target, the
+//   target shrinking as that preset's channel gets busier; the
+//   last (fastest) enabled preset otherwise
 // ─────────────────────────────────────────────────────────────────
-static void aes128ctr_lorawan(const uint8_t key[16], uint8_t dir,
-                               uint32_t devAddr, uint32_t fCnt,
-                               uint8_t *data, size_t len)
+static uint8_t meshPickPreset(size_t len)
 {
-    uint8_t numBlocks = (len + 15) / 16;
-    for (uint8_t i = 1; i <= numBlocks; i++) {
-        uint8_t Ai[16];
-        Ai[0]  = 0x01;
-        Ai[1]  = 0x00;
-        Ai[2]  = 0x00;
-        Ai[3]  = 0x00;
-        Ai[4]  = 0x00;
-        Ai[5]  = dir;
-        Ai[6]  = (uint8_t)(devAddr);
-        Ai[7]  = (uint8_t)(devAddr >> 8);
-        Ai[8]  = (uint8_t)(devAddr >> 16);
-        Ai[9]  = (uint8_t)(devAddr >> 24);
-        Ai[10] = (uint8_t)(fCnt);
-        Ai[11] = (uint8_t)(fCnt >> 8);
-        Ai[12] = (uint8_t)(fCnt >> 16);
-        Ai[13] = (uint8_t)(fCnt >> 24);
-        Ai[14] = 0x00;
-        Ai[15] = i;
+    for (uint8_t i = 0; i < MESH_ENABLED_COUNT; i++) {
+        uint8_t p = meshEnabled[i];
+        uint32_t targetUs = (uint32_t)MESH_TOA_TARGET_MS * 1000 / 256 *
+                            (256 - meshStats[p].busyQ8);
+        if (meshPresets[p].toaUs(len) <= targetUs) return p;
+    }
+    return meshEnabled[MESH_ENABLED_COUNT - 1];
+}
 
-        uint8_t Si[16];
-        aes128_ecb_encrypt(key, Ai, Si);
+// ─────────────────────────────────────────────────────────────────
+// delay() for the radio task
+//   Time it spends blocked in the middle of a pass, here or in
+//   radioWaitDio1(), is left out of its busy time, so the charge
+//   estimate counts the MCU asleep through a TX or RX window
+// ─────────────────────────────────────────────────────────────────
+static uint32_t radioSleptUs = 0;
 
-        size_t offset = (size_t)(i - 1) * 16;
-        size_t blockLen = (len - offset < 16) ? (len - offset) : 16;
-        for (size_t j = 0; j < blockLen; j++) {
-            data[offset + j] ^= Si[j];
-        }
-    }
+static void radioDelay(uint32_t ms)
+{
+    uint32_t t0 = micros();
+    delay(ms);
+    radioSleptUs += micros() - t0;
 }
 
 // ─────────────────────────────────────────────────────────────────
-// AES-CMAC (RFC 4493) — used for LoRaWAN MIC
+// Sample the channel of every enabled preset for activity
+//   A few instantaneous RSSI reads per channel, folded into a moving
+//   average: a channel busy x % of the time reads busy in about x %
+//   of the samples over many calls. Takes ~10 ms per preset, asleep
+//   between samples, run after each Meshtastic TX while the radio is
+//   away from TEMPEST anyway
 // ─────────────────────────────────────────────────────────────────
-static void aes_cmac(const uint8_t key[16], const uint8_t *msg, size_t len,
-                     uint8_t mac[16])
+#define MESH_BUSY_SAMPLES  8
+
+static void meshSampleBusy()
 {
-    // Step 1: Generate subkeys K1, K2
-    uint8_t L[16], K1[16], K2[16];
-    uint8_t zeros[16];
-    memset(zeros, 0, 16);
-    aes128_ecb_encrypt(key, zeros, L);
+    for (uint8_t i = 0; i < MESH_ENABLED_COUNT; i++) {
+        uint8_t p = meshEnabled[i];
+        configMeshtastic(p);
+        radio.startReceive();
+        radioDelay(2);              // at least a tick: let the RSSI settle
+
+        uint8_t busy = 0;
+        for (uint8_t n = 0; n < MESH_BUSY_SAMPLES; n++) {
+            if (radio.getRSSI(false) > MESH_BUSY_RSSI_DBM) busy++;
+            radioDelay(1);
+        }
+        radio.standby();
 
-    // Left-shift L to get K1
-    uint8_t overflow = 0;
-    for (int i = 15; i >= 0; i--) {
-        uint8_t next_overflow = (L[i] & 0x80) ? 1 : 0;
-        K1[i] = (L[i] << 1) | overflow;
-        overflow = next_overflow;
+        // EWMA with alpha 1/8
+        uint8_t &b = meshStats[p].busyQ8;
+        b = (uint8_t)(b - b / 8 + (uint16_t)busy * 255 / MESH_BUSY_SAMPLES / 8);
     }
-    if (L[0] & 0x80) K1[15] ^= 0x87;
+}
 
-    // Left-shift K1 to get K2
-    overflow = 0;
-    for (int i = 15; i >= 0; i--) {
-        uint8_t next_overflow = (K1[i] & 0x80) ? 1 : 0;
-        K2[i] = (K1[i] << 1) | overflow;
-        overflow = next_overflow;
-    }
-    if (K1[0] & 0x80) K2[15] ^= 0x87;
+// ─────────────────────────────────────────────────────────────────
+// Start the RX timestamp timer: 16 MHz / 2^4, 32 bits
+// ─────────────────────────────────────────────────────────────────
+static void rxStampBegin()
+{
+    NRF_TIMER_Type *t = RX_STAMP_TIMER;
+    t->TASKS_STOP = 1;
+    t->MODE = TIMER_MODE_MODE_Timer;
+    t->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+    t->PRESCALER = 4;
+    t->TASKS_CLEAR = 1;
+    t->TASKS_START = 1;
+}
 
-    // Step 2: Determine number of blocks and completeness
-    size_t n = (len + 15) / 16;
-    bool lastComplete;
-    if (n == 0) {
-        n = 1;
-        lastComplete = false;
-    } else {
-        lastComplete = (len % 16 == 0);
+// ─────────────────────────────────────────────────────────────────
+// Route DIO1's GPIOTE event to the timer capture
+//   attachInterrupt() (setDio1Action) gives DIO1 a GPIOTE channel, and
+//   a pin can only have one, so the PPI channel listens to that one.
+//   Run after every setDio1Action() in case the channel moved
+// ─────────────────────────────────────────────────────────────────
+static void rxStampHook()
+{
+    uint32_t pin = g_ADigitalPinMap[RADIO_DIO1_PIN];
+    for (uint8_t ch = 0; ch < GPIOTE_CH_NUM; ch++) {
+        uint32_t cfg = NRF_GPIOTE->CONFIG[ch];
+        if ((cfg & GPIOTE_CONFIG_MODE_Msk) != (GPIOTE_CONFIG_MODE_Event << GPIOTE_CONFIG_MODE_Pos))
+            continue;
+        if (((cfg & (GPIOTE_CONFIG_PSEL_Msk | GPIOTE_CONFIG_PORT_Msk)) >> GPIOTE_CONFIG_PSEL_Pos) != pin)
+            continue;
+        NRF_PPI->CH[RX_STAMP_PPI_CH].EEP = (uintptr_t)&NRF_GPIOTE->EVENTS_IN[ch];
+        NRF_PPI->CH[RX_STAMP_PPI_CH].TEP = (uintptr_t)&RX_STAMP_TIMER->TASKS_CAPTURE[0];
+        NRF_PPI->CHENSET = 1UL << RX_STAMP_PPI_CH;
+        rxStampHw = true;
+        return;
     }
+    NRF_PPI->CHENCLR = 1UL << RX_STAMP_PPI_CH;
+    rxStampHw = false;
+}
 
-    // Step 3: CBC-MAC
-    uint8_t X[16];
-    memset(X, 0, 16);
+static uint32_t rxStampNow()
+{
+    RX_STAMP_TIMER->TASKS_CAPTURE[1] = 1;
+    return RX_STAMP_TIMER->CC[1];
+}
 
-    for (size_t i = 0; i < n; i++) {
-        uint8_t M[16];
-        if (i < n - 1) {
-            // Not the last block — straight copy
-            memcpy(M, msg + i * 16, 16);
-        } else {
-            // Last block
-            size_t remaining = len - i * 16;
-            memset(M, 0, 16);
-            memcpy(M, msg + i * 16, remaining);
-            if (lastComplete) {
-                for (int j = 0; j < 16; j++) M[j] ^= K1[j];
-            } else {
-                M[remaining] = 0x80;  // padding
-                for (int j = 0; j < 16; j++) M[j] ^= K2[j];
-            }
-        }
-        // XOR then encrypt
-        for (int j = 0; j < 16; j++) X[j] ^= M[j];
-        aes128_ecb_encrypt(key, X, X);
+// ─────────────────────────────────────────────────────────────────
+// Configure radio for TEMPEST-LoRaWAN RX (915 MHz, BW 500, SF 7)
+//   Tuned to the tracked emitter offset. Every channel the relay
+//   visits is within one image calibration band of 915 MHz, so the
+//   retune skips calibration: straight to setFrequencyRaw()
+// ─────────────────────────────────────────────────────────────────
+static void configTempest()
+{
+    if (rxGainApplied != (int8_t)rxBoosted) {
+        radio.setRxBoostedGainMode(rxBoosted);
+        rxGainApplied = (int8_t)rxBoosted;
     }
-
-    memcpy(mac, X, 16);
+    radio.setFrequency(LoRa_frequency + tempestTuneHz / 1e6f, true);
+    radio.setBandwidth(500);
+    radio.setSpreadingFactor(7);
+    radio.setCodingRate(5);
+    radio.setPreambleLength(8);
+    radio.setSyncWord(RADIOLIB_SX126X_SYNC_WORD_PRIVATE);
+    radio.setCRC(2);
 }
 
 // ─────────────────────────────────────────────────────────────────
-// Build LoRaWAN Unconfirmed Data Up frame
-//   Returns total frame length written into `out`
+// Build Meshtastic text message packet
+//   16-byte header followed by the encrypted Data protobuf, all
+//   written into `out` (MESH_MAX_LEN). With MESH_PACK_TEXT the text
+//   goes out packed (textpack.h) when that is shorter, packed into
+//   the caller's `scratch` (RX_MAX_LEN) first: each task that builds
+//   packets passes its own. The modem preset is picked for the final
+//   length and returned in `preset`, the bytes saved by packing in
+//   `packSaved`
+//   Returns packet length
 // ─────────────────────────────────────────────────────────────────
-static size_t buildLoRaWANUplink(uint8_t *out, const uint8_t *payload,
-                                  size_t payloadLen, uint32_t devAddr,
-                                  uint16_t fCnt)
+static size_t buildMeshtasticPacket(uint8_t *out, const uint8_t *text,
+                                    size_t textLen, uint32_t pktId, uint8_t *scratch,
+                                    uint8_t *preset, uint16_t *packSaved)
 {
+    uint32_t portnum = 1;               // TEXT_MESSAGE_APP
+    const uint8_t *payload = text;
+    size_t payloadLen = textLen;
+    if (MESH_PACK_TEXT && textLen > 2) {
+        // the packed portnum takes a 2-byte varint, so only accept
+        // a gain of 2 bytes or more
+        size_t packedLen = textPack(text, textLen, scratch, textLen - 2);
+        if (packedLen) {
+            portnum = TEXTPACK_PORTNUM;
+            payload = scratch;
+            payloadLen = packedLen;
+        }
+    }
+
+    // Encode as Meshtastic protobuf behind the header
+    uint8_t *pb = &out[MESH_HDR_LEN];
+    size_t pbLen = encodeDataProtobuf(pb, portnum, payload, payloadLen);
+    *packSaved = (uint16_t)(uplinkLen(TXQ_MESH, textLen) - (MESH_HDR_LEN + pbLen));
+    *preset = meshPickPreset(MESH_HDR_LEN + pbLen);
+
+    // Encrypt with AES-128-CTR (in place)
+    aes128ctr_encrypt(meshKey, pktId, DEVICE_NODE_ID, pb, pbLen);
+
+    // Build 16-byte Meshtastic header
+    uint8_t *meshPkt = out;
     size_t pos = 0;
 
-    // MHDR: Unconfirmed Data Up, LoRaWAN R1
-    out[pos++] = 0x40;
-
-    // DevAddr (4 bytes LE)
-    out[pos++] = (uint8_t)(devAddr);
-    out[pos++] = (uint8_t)(devAddr >> 8);
-    out[pos++] = (uint8_t)(devAddr >> 16);
-    out[pos++] = (uint8_t)(devAddr >> 24);
-
-    // FCtrl: no ADR, no ACK, no FOptsLen
-    out[pos++] = 0x00;
-
-    // FCnt (lower 16 bits, LE)
-    out[pos++] = (uint8_t)(fCnt);
-    out[pos++] = (uint8_t)(fCnt >> 8);
-
-    // FPort = 1 (application data)
-    out[pos++] = 0x01;
-
-    // FRMPayload: encrypt in-place copy
-    memcpy(&out[pos], payload, payloadLen);
-    aes128ctr_lorawan(appSKey, 0, devAddr, (uint32_t)fCnt,
-                      &out[pos], payloadLen);
-    pos += payloadLen;
-
-    // Compute MIC over B0 || MHDR..FRMPayload
-    size_t msgLen = pos;  // everything so far
-    uint8_t micInput[16 + 256];
-    // B0 block
-    micInput[0]  = 0x49;
-    micInput[1]  = 0x00;
-    micInput[2]  = 0x00;
-    micInput[3]  = 0x00;
-    micInput[4]  = 0x00;
-    micInput[5]  = 0x00;  // Dir = 0 (uplink)
-    micInput[6]  = (uint8_t)(devAddr);
-    micInput[7]  = (uint8_t)(devAddr >> 8);
-    micInput[8]  = (uint8_t)(devAddr >> 16);
-    micInput[9]  = (uint8_t)(devAddr >> 24);
-    micInput[10] = (uint8_t)(fCnt);
-    micInput[11] = (uint8_t)(fCnt >> 8);
-    micInput[12] = 0x00;
-    micInput[13] = 0x00;
-    micInput[14] = 0x00;
-    micInput[15] = (uint8_t)(msgLen);
-    memcpy(&micInput[16], out, msgLen);
-
-    uint8_t fullMac[16];
-    aes_cmac(nwkSKey, micInput, 16 + msgLen, fullMac);
-
-    // Append first 4 bytes of CMAC as MIC
-    out[pos++] = fullMac[0];
-    out[pos++] = fullMac[1];
-    out[pos++] = fullMac[2];
-    out[pos++] = fullMac[3];
+    // to (4 bytes LE) — broadcast
+    meshPkt[pos++] = (uint8_t)(MESH_BROADCAST);
+    meshPkt[pos++] = (uint8_t)(MESH_BROADCAST >> 8);
+    meshPkt[pos++] = (uint8_t)(MESH_BROADCAST >> 16);
+    meshPkt[pos++] = (uint8_t)(MESH_BROADCAST >> 24);
+
+    // from (4 bytes LE)
+    meshPkt[pos++] = (uint8_t)(DEVICE_NODE_ID);
+    meshPkt[pos++] = (uint8_t)(DEVICE_NODE_ID >> 8);
+    meshPkt[pos++] = (uint8_t)(DEVICE_NODE_ID >> 16);
+    meshPkt[pos++] = (uint8_t)(DEVICE_NODE_ID >> 24);
 
+    // packet id (4 bytes LE)
+    meshPkt[pos++] = (uint8_t)(pktId);
+    meshPkt[pos++] = (uint8_t)(pktId >> 8);
+    meshPkt[pos++] = (uint8_t)(pktId >> 16);
+    meshPkt[pos++] = (uint8_t)(pktId >> 24);
+
+    // flags (1 byte)
+    meshPkt[pos++] = MESH_FLAGS;
+
+    // channel hash (1 byte)
+    meshPkt[pos++] = meshPresets[*preset].hash;
+
+    // padding (2 bytes, reserved)
+    meshPkt[pos++] = 0x00;
+    meshPkt[pos++] = 0x00;
+
+    // Encrypted protobuf already follows the header
+    pos += pbLen;
     return pos;
 }
 
 // ─────────────────────────────────────────────────────────────────
-// Configure radio for LoRaWAN TX (US915 sub-band 2, BW 125, SF 7)
+// Configure radio for LoRaWAN TX (US915 sub-band 2)
+//   DR3: BW 125, SF 7 / DR4: BW 500, SF 8
 // ─────────────────────────────────────────────────────────────────
-static void configLoRaWAN(float freq)
+static void configLoRaWAN(float freq, uint8_t dr)
 {
     radio.setFrequency(freq);
-    radio.setBandwidth(125);
-    radio.setSpreadingFactor(7);
+    radio.setBandwidth(dr == 4 ? 500 : 125);
+    radio.setSpreadingFactor(dr == 4 ? 8 : 7);
     radio.setCodingRate(5);
     radio.setPreambleLength(8);
     radio.setSyncWord(0x34);        // public LoRaWAN sync word
@@ -451,230 +910,1926 @@ static void configLoRaWAN(float freq)
 }
 
 // ─────────────────────────────────────────────────────────────────
-void setup()
+// Time on air of a LoRa LoRaWAN uplink at DR3 / DR4, in µs
+// ─────────────────────────────────────────────────────────────────
+static uint32_t lorawanToaUs(uint8_t dr, size_t len)
 {
-    initBoard();
-    delay(10);
-
-    // Init OLED (address 0x3d)
-    u8g2.setI2CAddress(0x3d << 1);
-    u8g2.begin();
-    displayStatus("TEMPEST-LoRaWAN", "", "Booting...", "");
-
-    if (Serial) Serial.print(F("[TEMPEST-LoRa] Initializing radio ... "));
+    return dr == 4 ? ToaLoRaWANDr4::us(len) : ToaLoRaWAN::us(len);
+}
 
-    // Begin with TCXO voltage; initial params don't matter much
-    // since we immediately call configTempest()
-    int state = radio.begin(
-        LoRa_frequency,
-        500.0,
-        7,
-        5,
-        RADIOLIB_SX126X_SYNC_WORD_PRIVATE,
-        10,
-        8,
-        RADIO_TCXO_VOLTAGE
-    );
+// ─────────────────────────────────────────────────────────────────
+// Pick the US915 data rate of a `len` byte LoRaWAN uplink
+//   Of the LoRa DRs the frame fits (FRMPayload + FOpts within N,
+//   400 ms dwell on the 125 kHz channels), the one with the shortest
+//   time on air whose link margin clears the floor. DR4 is only
+//   trusted once a LinkCheckAns has reported the margin
+// ─────────────────────────────────────────────────────────────────
+static uint8_t lorawanPickDr(size_t len)
+{
+    if (LORAWAN_UPLINK_LRFHSS || LORAWAN_UPLINK_DR == 4) return LORAWAN_UPLINK_DR;
 
-    // RF switch setup
-    radio.setDio2AsRfSwitch(true);
-    radio.setRfSwitchPins(RADIO_RXEN_PIN, RADIOLIB_NC);
+    size_t appLen = len > 13 ? len - 13 : 0;    // FOpts + FRMPayload
+    bool dr3 = appLen <= US915.payloadLenMax[3] &&
+               lorawanToaUs(3, len) <= LORAWAN_DWELL_US;
+    bool dr4 = appLen <= US915.payloadLenMax[4] &&
+               lorawanMargin != LW_MARGIN_UNKNOWN &&
+               lorawanMargin - LW_DR4_PENALTY_DB >= LORAWAN_DR4_MARGIN_FLOOR_DB;
 
-    // Apply TEMPEST-LoRaWAN settings
-    configTempest();
+    if (dr4 && (!dr3 || lorawanToaUs(4, len) < lorawanToaUs(3, len))) return 4;
+    return 3;   // too long for either: dropped for dwell time by the scheduler
+}
 
-    if (state == RADIOLIB_ERR_NONE) {
-        if (Serial) Serial.println(F("success!"));
-    } else {
-        if (Serial) { Serial.print(F("failed, code ")); Serial.println(state); }
-        displayStatus("TEMPEST-LoRaWAN", "", "RADIO INIT FAIL", "");
-        while (true);
+// ─────────────────────────────────────────────────────────────────
+// Whether the next LoRaWAN uplink should carry a LinkCheckReq
+//   LR-FHSS uplinks have no DR choice to make, so they never do
+// ─────────────────────────────────────────────────────────────────
+static bool lorawanLinkCheckNext()
+{
+    if (LORAWAN_UPLINK_LRFHSS || LORAWAN_LINKCHECK_EVERY == 0) return false;
+    if (lorawanLinkCheckDue) {
+        lorawanLinkCheckDue--;
+        return false;
     }
+    lorawanLinkCheckDue = LORAWAN_LINKCHECK_EVERY - 1;
+    return true;
+}
 
-    // Set up receive interrupt
-    radio.setDio1Action(setFlag);
+// ─────────────────────────────────────────────────────────────────
+// Time on air of an uplink frame in µs, for the fixed TX profiles
+//   of configLoRaWAN() / sendLrFhss() and configMeshtastic().
+//   `rate` is the Meshtastic preset or LoRaWAN DR the frame was
+//   built for (unused for LR-FHSS). LoRa profiles come from the
+//   compile-time tables in airtime.h
+// ─────────────────────────────────────────────────────────────────
+static uint32_t uplinkToaUs(uint8_t q, size_t len, uint8_t rate)
+{
+    if (q == TXQ_MESH) return meshPresets[rate].toaUs(len);
+    if (!LORAWAN_UPLINK_LRFHSS) return lorawanToaUs(rate, len);
+
+    DataRate_t dr = {};
+    PacketConfig_t pc = {};
+    dr.lrFhss.bw = RADIOLIB_SX126X_LR_FHSS_BW_1523_4;
+    dr.lrFhss.cr = LORAWAN_FHSS_CR;
+    dr.lrFhss.narrowGrid = false;
+    pc.lrFhss.hdrCount = LORAWAN_FHSS_HDR;
+    return radio.calculateTimeOnAir(RADIOLIB_MODEM_LRFHSS, dr, pc, len);
+}
 
-    state = radio.startReceive();
-    if (state == RADIOLIB_ERR_NONE) {
-        if (Serial) Serial.println(F("[TEMPEST-LoRa] Listening on 915 MHz (BW500/SF7) ... success!"));
+// ─────────────────────────────────────────────────────────────────
+// Listen-before-talk backoff slot of the head of `q`
+//   Long enough for a CAD (2-4 symbols) and the TX turnaround, so
+//   relays picking different slots hear each other's preamble
+// ─────────────────────────────────────────────────────────────────
+#define LBT_SNR_MIN  (-20)
+#define LBT_SNR_MAX  10
+
+static uint32_t lbtSlotUs(uint8_t q, const RelayFrame *f)
+{
+    uint32_t symbolUs;
+    if (q == TXQ_MESH) {
+        const MeshPreset &mp = meshPresets[f->meshPreset];
+        symbolUs = ((uint32_t)1000 << mp.sf) / mp.bwKhz;
     } else {
-        if (Serial) { Serial.print(F("startReceive failed, code ")); Serial.println(state); }
-        displayStatus("TEMPEST-LoRaWAN", "", "RX START FAIL", "");
-        while (true);
+        symbolUs = f->lwDr == 4 ? ToaLoRaWANDr4::SymbolUs : ToaLoRaWAN::SymbolUs;
     }
-
-    displayStatus("TEMPEST-LoRaWAN", "", "Listening 915MHz", "BW500 / SF7");
+    return 4 * symbolUs + 1000;
 }
 
 // ─────────────────────────────────────────────────────────────────
-void loop()
+// Start the contention window of the head of `q`
+//   CW from the frame's TEMPEST SNR, plus one per busy CAD so far
+// ─────────────────────────────────────────────────────────────────
+static void lbtArm(uint8_t q, uint32_t now)
 {
-    if (!receivedFlag) return;
-
-    // Disable interrupt while processing
-    enableInterrupt = false;
-    receivedFlag = false;
-
-    // ── 1. Read TEMPEST-LoRaWAN packet ─────────────────────────────
-    uint8_t buf[256];
-    int len = radio.getPacketLength();
-    int state = radio.readData(buf, len);
+    TxQueue &tq = txQueues[q];
+    RelayFrame *f = txqHead(q);
+
+    int32_t snr = (int32_t)f->info.snr;
+    if (snr < LBT_SNR_MIN) snr = LBT_SNR_MIN;
+    if (snr > LBT_SNR_MAX) snr = LBT_SNR_MAX;
+    uint8_t cw = LBT_CW_MIN + tq.lbtTries +
+                 (snr - LBT_SNR_MIN) * (LBT_CW_MAX - LBT_CW_MIN) / (LBT_SNR_MAX - LBT_SNR_MIN);
+    if (cw > LBT_CW_MAX) cw = LBT_CW_MAX;
+
+    uint32_t waitMs = (uint32_t)random(1L << cw) * lbtSlotUs(q, f) / 1000;
+    tq.lbtSlot = (int8_t)(f - framePool);
+    tq.lbtUntil = now + waitMs;
+    tq.backoffMs += waitMs;
+}
 
-    if (state != RADIOLIB_ERR_NONE) {
-        if (Serial) { Serial.print(F("[TEMPEST-LoRa] Read error, code ")); Serial.println(state); }
-        goto resume_rx;
+// ─────────────────────────────────────────────────────────────────
+// Sleep until DIO1 rises or `timeoutMs` runs out
+//   For the radio task, while the CAD, TX or RX window it started
+//   runs. setFlag() notifies it on every DIO1 edge, so it blocks
+//   instead of polling the pin like RadioLib's blocking calls, whose
+//   yield() never lets a lower priority task run. Other
+//   notifications just go round again. Returns true if DIO1 is high
+// ─────────────────────────────────────────────────────────────────
+static bool radioWaitDio1(uint32_t timeoutMs)
+{
+    uint32_t start = millis();
+    while (!digitalRead(RADIO_DIO1_PIN)) {
+        uint32_t elapsed = millis() - start;
+        if (elapsed >= timeoutMs) return false;
+        uint32_t t0 = micros();
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs - elapsed));
+        radioSleptUs += micros() - t0;
     }
+    return true;
+}
 
-    {
-        // ── 2. Print to Serial (only when USB connected) ────────
-        float rssi = radio.getRSSI();
-        float snr  = radio.getSNR();
-        if (Serial) {
-            Serial.print(F("[TEMPEST-LoRa] Received "));
-            Serial.print(len);
-            Serial.print(F(" bytes: "));
-            for (int i = 0; i < len; i++) {
-                if (buf[i] < 0x10) Serial.print('0');
-                Serial.print(buf[i], HEX);
-                Serial.print(' ');
-            }
-            Serial.println();
-            Serial.print(F("[TEMPEST-LoRa] Text: "));
-            Serial.write(buf, len);
-            Serial.println();
-            Serial.print(F("[TEMPEST-LoRa] RSSI: "));
-            Serial.print(rssi);
-            Serial.print(F(" dBm, SNR: "));
-            Serial.print(snr);
-            Serial.println(F(" dB"));
-        }
-
-        // Show received text on display
-        {
-            char rxLine[22];
-            char rssiLine[22];
-            snprintf(rxLine, sizeof(rxLine), "RX: %.*s", (len > 16 ? 16 : len), buf);
-            snprintf(rssiLine, sizeof(rssiLine), "RSSI:%d SNR:%.1f",
-                     (int)rssi, (double)snr);
-            displayStatus("TEMPEST-LoRaWAN", rxLine, "Relaying...", rssiLine);
-        }
-
-        // ── 3. LoRaWAN TX ──────────────────────────────────────────
-        uint8_t lwPkt[256];
-        size_t lwLen = buildLoRaWANUplink(lwPkt, buf, (size_t)len,
-                                          LORAWAN_DEV_ADDR, lorawanFCnt);
-
-        float lwFreq = lorawanFreqs[lorawanChIdx];
-        lorawanChIdx = (lorawanChIdx + 1) % 8;
-
-        if (Serial) {
-            Serial.print(F("[LoRaWAN] Sending "));
-            Serial.print(lwLen);
-            Serial.print(F(" bytes on "));
-            Serial.print(lwFreq, 1);
-            Serial.print(F(" MHz (FCnt="));
-            Serial.print(lorawanFCnt);
-            Serial.print(F(") ... "));
-        }
-
-        configLoRaWAN(lwFreq);
-        state = radio.transmit(lwPkt, lwLen);
-
-        if (state == RADIOLIB_ERR_NONE) {
-            if (Serial) Serial.println(F("OK"));
-        } else {
-            if (Serial) { Serial.print(F("failed, code ")); Serial.println(state); }
-        }
-        lorawanFCnt++;
-
-        // ── 4. Encode as Meshtastic protobuf ────────────────────
-        uint8_t pbBuf[256];
-        size_t pbLen = encodeDataProtobuf(pbBuf, 1, buf, (size_t)len);
-        // portnum=1 is TEXT_MESSAGE_APP
+// ─────────────────────────────────────────────────────────────────
+// CAD on the channel just configured for `q`
+//   Only a detected preamble counts as busy; a failed scan lets the
+//   frame go
+// ─────────────────────────────────────────────────────────────────
+#define LBT_CAD_TIMEOUT_MS  250     // 4 symbols of SF12 at 125 kHz take 131
 
-        // ── 5. Encrypt with AES-128-CTR ─────────────────────────
-        uint32_t pktId = packetIdCounter++;
-        aes128ctr_encrypt(meshKey, pktId, DEVICE_NODE_ID, pbBuf, pbLen);
+static bool lbtBusy(uint8_t q)
+{
+    if (!txQueues[q].lbt) return false;
+    if (radio.startChannelScan() == RADIOLIB_ERR_NONE && radioWaitDio1(LBT_CAD_TIMEOUT_MS) &&
+        radio.getChannelScanResult() == RADIOLIB_LORA_DETECTED) return true;
+    txQueues[q].cadClear++;
+    return false;
+}
 
-        // ── 6. Build 16-byte Meshtastic header ──────────────────
-        uint8_t meshPkt[256 + 16];
-        size_t pos = 0;
+// ─────────────────────────────────────────────────────────────────
+// Back off the head of `q` after a busy CAD, or give up on it
+// ─────────────────────────────────────────────────────────────────
+static void lbtBackoff(uint8_t q)
+{
+    TxQueue &tq = txQueues[q];
+    tq.cadBusy++;
+    if (++tq.lbtTries >= LBT_MAX_TRIES) {
+        tq.cadGaveUp++;
+        txqDrop(q, F("channel busy"));
+        return;
+    }
+    lbtArm(q, millis());
+    if (Serial) {
+        Log.print(F("[LBT] "));
+        Log.print(tq.name);
+        Log.print(F(" channel busy, retry "));
+        Log.print(tq.lbtTries);
+        Log.print(F(" in "));
+        Log.print(tq.lbtUntil - millis());
+        Log.println(F(" ms"));
+    }
+}
 
-        // to (4 bytes LE) — broadcast
-        meshPkt[pos++] = (uint8_t)(MESH_BROADCAST);
-        meshPkt[pos++] = (uint8_t)(MESH_BROADCAST >> 8);
-        meshPkt[pos++] = (uint8_t)(MESH_BROADCAST >> 16);
-        meshPkt[pos++] = (uint8_t)(MESH_BROADCAST >> 24);
+// ─────────────────────────────────────────────────────────────────
+// Preload a frame into the TX region of the SX1262 buffer.
+//   Safe while still in RX as long as received packets fit the RX
+//   region; preloadRxLanded() drops the preload when one doesn't.
+//   Frames that don't fit the TX region are written at TX time
+//   instead. Returns true if the frame was preloaded
+// ─────────────────────────────────────────────────────────────────
+static RelayFrame *preloadedFrame = NULL;   // whose uplink is in the TX region
 
-        // from (4 bytes LE)
-        meshPkt[pos++] = (uint8_t)(DEVICE_NODE_ID);
-        meshPkt[pos++] = (uint8_t)(DEVICE_NODE_ID >> 8);
-        meshPkt[pos++] = (uint8_t)(DEVICE_NODE_ID >> 16);
-        meshPkt[pos++] = (uint8_t)(DEVICE_NODE_ID >> 24);
+static bool preloadTx(const uint8_t *data, size_t len)
+{
+    if (len > 256 - RADIO_BUF_TX_BASE) return false;
+    return radio.preloadTransmit(data, len) == RADIOLIB_ERR_NONE;
+}
 
-        // packet id (4 bytes LE)
-        meshPkt[pos++] = (uint8_t)(pktId);
-        meshPkt[pos++] = (uint8_t)(pktId >> 8);
-        meshPkt[pos++] = (uint8_t)(pktId >> 16);
-        meshPkt[pos++] = (uint8_t)(pktId >> 24);
+// A `len` byte packet was received, good or not (SIZE_MAX: unknown
+// length); past RADIO_BUF_RX_MAX it overwrote the preloaded uplink,
+// which is then written again at TX time
+static void preloadRxLanded(size_t len)
+{
+    if (!preloadedFrame || len <= RADIO_BUF_RX_MAX) return;
+    preloadedFrame = NULL;
+    if (Serial) Log.println(F("[TEMPEST-LoRa] Long packet overwrote the preloaded uplink"));
+}
 
-        // flags (1 byte)
-        meshPkt[pos++] = MESH_FLAGS;
+// ─────────────────────────────────────────────────────────────────
+// Send a LoRa frame, asleep until TX done
+//   Times out like RadioLib's transmit(), at 5x the time on air
+// ─────────────────────────────────────────────────────────────────
+static int sendTx(const uint8_t *data, size_t len, bool preloaded)
+{
+    int state = radio.standby();
 
-        // channel hash (1 byte)
-        meshPkt[pos++] = MESH_CHANNEL;
+    // preloaded frame only needs the packet params and SetTx
+    if (state == RADIOLIB_ERR_NONE) state = radio.startTransmit(preloaded ? NULL : data, len);
+    if (state != RADIOLIB_ERR_NONE) return state;
 
-        // padding (2 bytes, reserved)
-        meshPkt[pos++] = 0x00;
-        meshPkt[pos++] = 0x00;
+    if (!radioWaitDio1(5 + radio.getTimeOnAir(len) * 5 / 1000)) {
+        radio.finishTransmit();
+        return RADIOLIB_ERR_TX_TIMEOUT;
+    }
+    return radio.finishTransmit();
+}
 
-        // ── 7. Append encrypted protobuf ────────────────────────
-        memcpy(&meshPkt[pos], pbBuf, pbLen);
-        pos += pbLen;
+// ─────────────────────────────────────────────────────────────────
+// (Re)initialise the radio in LoRa mode
+//   Used at boot and to leave LR-FHSS, which needs a different
+//   packet type; configTempest() / configMeshtastic() take it from here
+// ─────────────────────────────────────────────────────────────────
+static int beginLoRaModem()
+{
+    rxGainApplied = -1;     // the reset drops back to power-saving gain
 
-        // ── 8. Switch to Meshtastic, transmit ───────────────────
-        if (Serial) {
-            Serial.print(F("[Meshtastic] Sending "));
-            Serial.print(pos);
-            Serial.print(F(" bytes (id=0x"));
-            Serial.print(pktId, HEX);
-            Serial.println(F(")"));
-            Serial.print(F("[Meshtastic] Packet: "));
-            for (size_t i = 0; i < pos; i++) {
-                if (meshPkt[i] < 0x10) Serial.print('0');
-                Serial.print(meshPkt[i], HEX);
-                Serial.print(' ');
+    // Begin with TCXO voltage; initial params don't matter much
+    // since we immediately call configTempest()
+    return radio.begin(
+        LoRa_frequency,
+        500.0,
+        7,
+        5,
+        RADIOLIB_SX126X_SYNC_WORD_PRIVATE,
+        10,
+        8,
+        RADIO_TCXO_VOLTAGE
+    );
+}
+
+// ─────────────────────────────────────────────────────────────────
+// LoRaWAN uplink over LR-FHSS (US915 DR5 / DR6)
+//   startTransmit() computes the whole hop sequence up front. Every
+//   SPI command has RadioLib allocate its buffers, so hop requests
+//   are not served from the DIO1 ISR: setFlag() wakes the radio task,
+//   which writes the next hop
+// ─────────────────────────────────────────────────────────────────
+static int sendLrFhss(const uint8_t *data, size_t len)
+{
+    int state = radio.beginLRFHSS(lorawanWideFreq, RADIOLIB_SX126X_LR_FHSS_BW_1523_4,
+                                  LORAWAN_FHSS_CR, false, 22, RADIO_TCXO_VOLTAGE);
+    if (state == RADIOLIB_ERR_NONE) state = radio.setLrFhssConfig(RADIOLIB_SX126X_LR_FHSS_BW_1523_4,
+                                                                  LORAWAN_FHSS_CR, LORAWAN_FHSS_HDR);
+    if (state == RADIOLIB_ERR_NONE) state = radio.setSyncWord((uint8_t *)lorawanFhssSyncWord, 4);
+
+    if (state == RADIOLIB_ERR_NONE) {
+        uint32_t timeoutMs = radio.getTimeOnAir(len) / 1000 + 500;
+        state = radio.startTransmit(data, len);
+
+        uint32_t start = millis();
+        while (state == RADIOLIB_ERR_NONE) {
+            uint32_t elapsed = millis() - start;
+            if (elapsed >= timeoutMs || !radioWaitDio1(timeoutMs - elapsed)) {
+                state = RADIOLIB_ERR_TX_TIMEOUT;
+                break;
             }
-            Serial.println();
-            Serial.print(F("[Meshtastic] TX ... "));
+            // anything that isn't a hop request is TX done
+            if (radio.hopLRFHSS() == RADIOLIB_ERR_TX_TIMEOUT) break;
         }
+        radio.finishTransmit();
+    }
 
-        configMeshtastic();
-        state = radio.transmit(meshPkt, pos);
+    // back to LoRa for Meshtastic / TEMPEST
+    beginLoRaModem();
+    return state;
+}
 
-        if (state == RADIOLIB_ERR_NONE) {
-            if (Serial) Serial.println(F("OK"));
-            relayCount++;
-        } else {
-            if (Serial) { Serial.print(F("failed, code ")); Serial.println(state); }
+// ─────────────────────────────────────────────────────────────────
+// Enter spectrum survey mode
+//   Tuning into the band once calibrates the image rejection for all
+//   of 902-928 MHz; from here on every step skips it
+// ─────────────────────────────────────────────────────────────────
+static void surveyBegin()
+{
+    radio.setBandwidth(SURVEY_RBW_KHZ);
+    radio.setFrequency(SURVEY_START_KHZ / 1000.0f);
+    radio.startReceive();
+    surveyReportMillis = millis();
+
+    if (Serial) {
+        Log.print(F("[Survey] "));
+        Log.print(SURVEY_START_KHZ / 1000.0f, 3);
+        Log.print(F(" - "));
+        Log.print(SURVEY_STOP_KHZ / 1000.0f, 3);
+        Log.print(F(" MHz, "));
+        Log.print(SURVEY_BINS);
+        Log.print(F(" steps of "));
+        Log.print(SURVEY_STEP_KHZ);
+        Log.println(F(" kHz"));
+    }
+    displayStatus("TEMPEST-LoRaWAN", "", "Spectrum survey", "");
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Stream the spectrum over serial
+//   [Survey] SPECTRUM <start kHz> <step kHz> <steps> max <hex> avg <hex>
+//   one byte per step, dBm = byte / 2 - 127.5
+// ─────────────────────────────────────────────────────────────────
+static void surveyPrintHex(const uint8_t *v, size_t stride)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    for (size_t i = 0; i < SURVEY_BINS; i++) {
+        uint8_t b = v[i * stride];
+        Log.write(hex[b >> 4]);
+        Log.write(hex[b & 0x0F]);
+    }
+}
+
+static void surveyReport(uint32_t now)
+{
+    uint16_t peak = 0;
+    for (uint16_t i = 1; i < SURVEY_BINS; i++)
+        if (surveyAvg[i] > surveyAvg[peak]) peak = i;
+
+    if (Serial) {
+        Log.print(F("[Survey] sweep "));
+        Log.print(surveySweeps);
+        Log.print(F(", "));
+        Log.print(surveySteps * 1000 / (now - surveyReportMillis));
+        Log.print(F(" steps/s, peak avg "));
+        Log.print((surveyAvg[peak] >> 8) / 2.0f - 127.5f, 1);
+        Log.print(F(" dBm @ "));
+        Log.print((SURVEY_START_KHZ + (uint32_t)peak * SURVEY_STEP_KHZ) / 1000.0f, 3);
+        Log.println(F(" MHz"));
+
+        Log.print(F("[Survey] SPECTRUM "));
+        Log.print(SURVEY_START_KHZ);
+        Log.print(' ');
+        Log.print(SURVEY_STEP_KHZ);
+        Log.print(' ');
+        Log.print(SURVEY_BINS);
+        Log.print(F(" max "));
+        surveyPrintHex(surveyMax, 1);
+        Log.print(F(" avg "));
+        // high byte of each little-endian Q8 average
+        surveyPrintHex((const uint8_t *)surveyAvg + 1, sizeof(surveyAvg[0]));
+        Log.println();
+    }
+
+    // OLED: average as bars, max-hold as a dot above, -125..-45 dBm
+    // over the 54 rows under the header
+    u8g2.clearBuffer();
+    u8g2.setFont(u8g2_font_5x7_tf);
+    char hdr[32];
+    snprintf(hdr, sizeof(hdr), "%lu-%luMHz pk%d@%.2f",
+             (unsigned long)(SURVEY_START_KHZ / 1000), (unsigned long)(SURVEY_STOP_KHZ / 1000),
+             (int)((surveyAvg[peak] >> 8) / 2 - 127),
+             (double)((SURVEY_START_KHZ + (uint32_t)peak * SURVEY_STEP_KHZ) / 1000.0f));
+    u8g2.drawStr(0, 7, hdr);
+    for (uint8_t x = 0; x < 128; x++) {
+        uint16_t from = (uint32_t)x * SURVEY_BINS / 128;
+        uint16_t to = (uint32_t)(x + 1) * SURVEY_BINS / 128;
+        if (to <= from) to = from + 1;
+        uint8_t avg = 0, max = 0;
+        for (uint16_t i = from; i < to; i++) {
+            if ((surveyAvg[i] >> 8) > avg) avg = surveyAvg[i] >> 8;
+            if (surveyMax[i] > max) max = surveyMax[i];
         }
+        int h = ((int)avg - 5) * 54 / 160;
+        int m = ((int)max - 5) * 54 / 160;
+        h = h < 0 ? 0 : (h > 54 ? 54 : h);
+        m = m < 0 ? 0 : (m > 54 ? 54 : m);
+        if (h) u8g2.drawVLine(x, 64 - h, h);
+        u8g2.drawPixel(x, 63 - m);
+    }
+    u8g2.sendBuffer();
 
-        // Show result on display
-        {
-            char rxLine[22];
-            char txLine[22];
-            char cntLine[22];
-            snprintf(rxLine, sizeof(rxLine), "RX: %.*s", (len > 16 ? 16 : len), buf);
-            snprintf(txLine, sizeof(txLine), "TX: OK");
-            snprintf(cntLine, sizeof(cntLine), "Relayed: %lu", (unsigned long)relayCount);
-            displayStatus("TEMPEST-LoRaWAN", rxLine, txLine, cntLine);
+    surveySteps = 0;
+    surveyReportMillis = now;
+}
+
+// ─────────────────────────────────────────────────────────────────
+// One sweep across the survey range
+//   Four SPI commands and SURVEY_SETTLE_US per step, no image
+//   calibration; the full 902-928 MHz sweep takes about 0.1 s
+// ─────────────────────────────────────────────────────────────────
+static void surveySweep()
+{
+    for (uint16_t i = 0; i < SURVEY_BINS; i++) {
+        uint8_t raw;
+        float freq = (SURVEY_START_KHZ + (uint32_t)i * SURVEY_STEP_KHZ) / 1000.0f;
+        if (radio.sweepRssi(freq, SURVEY_SETTLE_US, &raw) != RADIOLIB_ERR_NONE) continue;
+
+        uint8_t level = 255 - raw;
+        if (level > surveyMax[i]) surveyMax[i] = level;
+        if (!surveySweeps) surveyAvg[i] = (uint16_t)level << 8;
+        else surveyAvg[i] = (uint16_t)(surveyAvg[i] + ((int32_t)level * 256 - surveyAvg[i]) / 8);
+    }
+    surveySweeps++;
+    surveySteps += SURVEY_BINS;
+
+    uint32_t now = millis();
+    if (now - surveyReportMillis >= SURVEY_REPORT_MS) surveyReport(now);
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Cycle counts of the RAMFUNC code, printed at boot
+//   Best of RAMFUNC_BENCH_RUNS calls, so an interrupt in between
+//   doesn't count. Build with FAST_RAM 0 and 1 to compare
+// ─────────────────────────────────────────────────────────────────
+#define RAMFUNC_BENCH_RUNS  32
+
+static void ramfuncBench()
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    static const char *const names[] = {
+        "aes128_ecb_encrypt", "aes128ctr_encrypt 64 B", "aes128ctr_lorawan 64 B", "aes_cmac 64 B",
+    };
+    uint8_t block[16] = {};
+    uint8_t buf[64] = {};
+    for (uint8_t fn = 0; fn < 4; fn++) {
+        uint32_t best = UINT32_MAX;
+        for (uint8_t r = 0; r < RAMFUNC_BENCH_RUNS; r++) {
+            uint32_t t0 = DWT->CYCCNT;
+            switch (fn) {
+            case 0: aes128_ecb_encrypt(nwkSKey, block, block); break;
+            case 1: aes128ctr_encrypt(meshKey, r, DEVICE_NODE_ID, buf, sizeof(buf)); break;
+            case 2: aes128ctr_lorawan(appSKey, 0, LORAWAN_DEV_ADDR, r, buf, sizeof(buf)); break;
+            case 3: aes_cmac(nwkSKey, buf, sizeof(buf), block); break;
+            }
+            uint32_t cycles = DWT->CYCCNT - t0;
+            if (cycles < best) best = cycles;
+        }
+        if (Serial) {
+            Log.print(F("[RAM] "));
+            Log.print(names[fn]);
+            Log.print(F(": "));
+            Log.print(best);
+            Log.println(FAST_RAM ? F(" cycles from RAM") : F(" cycles from flash"));
         }
     }
+}
+
+static void startTasks();
+static void mspPaint();
+
+void setup()
+{
+    mspPaint();
+    initBoard();
+    delay(10);
+    if (RAMFUNC_BENCH) ramfuncBench();
+
+    // Init OLED (address 0x3d)
+    u8g2.setI2CAddress(0x3d << 1);
+    u8g2.begin();
+    displayStatus("TEMPEST-LoRaWAN", "", "Booting...", "");
+
+    if (Serial) Log.print(F("[TEMPEST-LoRa] Initializing radio ... "));
+
+    int state = beginLoRaModem();
 
-resume_rx:
-    // ── 8. Switch back to TEMPEST-LoRaWAN and resume listening ─────
+    // RF switch setup
+    radio.setDio2AsRfSwitch(true);
+    radio.setRfSwitchPins(RADIO_RXEN_PIN, RADIOLIB_NC);
+
+    // Separate RX / TX regions so uplinks can be preloaded during RX
+    radio.setBufferSplit(RADIO_BUF_TX_BASE, RADIO_BUF_RX_BASE);
+
+    // Apply TEMPEST-LoRaWAN settings
     configTempest();
+
+    if (state == RADIOLIB_ERR_NONE) {
+        if (Serial) Log.println(F("success!"));
+    } else {
+        if (Serial) { Log.print(F("failed, code ")); Log.println(state); }
+        displayStatus("TEMPEST-LoRaWAN", "", "RADIO INIT FAIL", "");
+        while (true);
+    }
+
+    if (SURVEY_MODE) {
+        surveyBegin();
+        return;
+    }
+
+    txqBudgetInit();
+
+    // contention windows must differ between relays booted together
+    uint32_t seed = 0;
+    for (uint8_t i = 0; i < 4; i++) seed = (seed << 8) | radio.randomByte();
+    randomSeed(seed);
+
+    // Set up receive interrupt, timestamped in hardware
     radio.setDio1Action(setFlag);
-    radio.startReceive();
-    enableInterrupt = true;
+    rxStampBegin();
+    rxStampHook();
+
+    state = radio.startReceive();
+    if (state == RADIOLIB_ERR_NONE) {
+        if (Serial) Log.println(F("[TEMPEST-LoRa] Listening on 915 MHz (BW500/SF7) ... success!"));
+    } else {
+        if (Serial) { Log.print(F("startReceive failed, code ")); Log.println(state); }
+        displayStatus("TEMPEST-LoRaWAN", "", "RX START FAIL", "");
+        while (true);
+    }
+
+    if (SNIFFER_MODE) {
+        if (Serial) Log.println(F("[Sniffer] LoRaTap records follow, text muted"));
+        displayStatus("TEMPEST-LoRaWAN", "", "Sniffing 915MHz", "BW500 / SF7");
+    } else {
+        displayStatus("TEMPEST-LoRaWAN", "", "Listening 915MHz", "BW500 / SF7");
+    }
+    startTasks();
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Fold a good packet's frequency error into the offset estimate
+//   The new tuning takes effect when the radio task calls configTempest()
+//   after this packet
+// ─────────────────────────────────────────────────────────────────
+static void tempestTrackOffset(float freqError)
+{
+    int32_t offset = tempestTuneHz + (int32_t)freqError;
+    tempestAfcHist[tempestAfcPackets % AFC_HISTORY] = offset;
+    if (tempestAfcPackets++ == 0) tempestOffsetHz = offset;
+    else tempestOffsetHz += (offset - tempestOffsetHz) / 8;
+
+    int32_t target = tempestOffsetHz;
+    if (target > TEMPEST_AFC_MAX_HZ) target = TEMPEST_AFC_MAX_HZ;
+    if (target < -TEMPEST_AFC_MAX_HZ) target = -TEMPEST_AFC_MAX_HZ;
+    int32_t step = target - tempestTuneHz;
+    bool retune = tempestAfcPackets >= AFC_MIN_PACKETS &&
+                  (step >= TEMPEST_AFC_STEP_HZ || step <= -TEMPEST_AFC_STEP_HZ);
+
+    if (Serial) {
+        Log.print(F("[AFC] offset "));
+        Log.print(offset);
+        Log.print(F(" Hz, estimate "));
+        Log.print(tempestOffsetHz);
+        Log.print(F(" Hz, tuned "));
+        Log.print(tempestTuneHz);
+        Log.println(F(" Hz"));
+    }
+    if (!retune) return;
+
+    tempestTuneHz = target;
+    tempestRetunes++;
+    if (Serial) {
+        Log.print(F("[AFC] Retune #"));
+        Log.print(tempestRetunes);
+        Log.print(F(" to "));
+        Log.print(LoRa_frequency + tempestTuneHz / 1e6f, 6);
+        Log.print(F(" MHz, last offsets:"));
+        uint8_t n = tempestAfcPackets < AFC_HISTORY ? tempestAfcPackets : AFC_HISTORY;
+        for (uint8_t i = n; i > 0; i--) {
+            Log.print(' ');
+            Log.print(tempestAfcHist[(tempestAfcPackets - i) % AFC_HISTORY]);
+        }
+        Log.println(F(" Hz"));
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Sample the TEMPEST noise floor while idle in RX
+//   One instantaneous RSSI read every RX_NOISE_EVERY_MS; costs one
+//   SPI command, the radio stays in RX
+// ─────────────────────────────────────────────────────────────────
+static void rxSampleNoise()
+{
+    uint32_t now = millis();
+    if (now - rxNoiseMillis < RX_NOISE_EVERY_MS) return;
+    rxNoiseMillis = now;
+
+    int16_t rssi = (int16_t)radio.getRSSI(false);
+    if (!rxNoiseCount || rssi < rxNoiseMin) rxNoiseMin = rssi;
+    if (++rxNoiseCount < RX_NOISE_WINDOW) return;
+
+    rxNoiseCount = 0;
+    if (rxNoiseDbm == RX_NOISE_UNKNOWN) rxNoiseDbm = rxNoiseMin;
+    else rxNoiseDbm += (rxNoiseMin - rxNoiseDbm) / 4;
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Account a TEMPEST packet and pick the RX gain mode
+//   The new mode takes effect when the radio task calls configTempest()
+//   after this packet
+// ─────────────────────────────────────────────────────────────────
+static void rxGainUpdate(bool ok, float snr)
+{
+    int16_t marginQ4 = (int16_t)(snr * 16) - RX_SNR_FLOOR_Q4;
+    if (ok) {
+        rxGainOk[rxBoosted]++;
+        if (rxMarginQ4 == INT16_MIN) rxMarginQ4 = marginQ4;
+        else rxMarginQ4 += (marginQ4 - rxMarginQ4) / 8;
+        rxCrcScore -= rxCrcScore / 8;
+    } else {
+        rxGainCrc[rxBoosted]++;
+        if (marginQ4 < RX_BOOST_MARGIN_DB * 16)
+            rxCrcScore = rxCrcScore > 255 - RX_CRC_SCORE_STEP ? 255 : rxCrcScore + RX_CRC_SCORE_STEP;
+    }
+
+    bool boost = rxBoosted;
+    if (RX_BOOST_GAIN != 1) {
+        boost = RX_BOOST_GAIN == 2;
+    } else if (rxNoiseDbm != RX_NOISE_UNKNOWN && rxNoiseDbm >= RX_BOOST_NOISE_DBM) {
+        boost = false;
+    } else if (rxCrcScore >= RX_CRC_SCORE_BOOST ||
+               (rxMarginQ4 != INT16_MIN && rxMarginQ4 < RX_BOOST_MARGIN_DB * 16)) {
+        boost = true;
+    } else if (rxCrcScore < RX_CRC_SCORE_BOOST / 2 && rxMarginQ4 != INT16_MIN &&
+               rxMarginQ4 >= (RX_BOOST_MARGIN_DB + RX_BOOST_HYST_DB) * 16) {
+        boost = false;
+    }
+
+    uint32_t now = millis();
+    rxGainMs[rxBoosted] += now - rxGainSince;
+    rxGainSince = now;
+    if (boost != rxBoosted) {
+        rxBoosted = boost;
+        if (Serial) {
+            Log.print(F("[Gain] RX "));
+            Log.println(boost ? F("boosted") : F("power saving"));
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────
+// RX gain counters: time and packet success rate in each mode
+// ─────────────────────────────────────────────────────────────────
+static void printRxGainStats()
+{
+    if (!Serial) return;
+    Log.print(F("[Gain] noise="));
+    if (rxNoiseDbm == RX_NOISE_UNKNOWN) Log.print('?');
+    else Log.print(rxNoiseDbm);
+    Log.print(F(" dBm margin="));
+    if (rxMarginQ4 == INT16_MIN) Log.print('?');
+    else Log.print(rxMarginQ4 / 16.0f, 1);
+    Log.print(F(" dB crcScore="));
+    Log.print(rxCrcScore);
+    for (uint8_t m = 0; m < 2; m++) {
+        uint32_t total = rxGainOk[m] + rxGainCrc[m];
+        Log.print(m ? F(" | boosted ") : F(" | saving "));
+        Log.print(rxGainMs[m] / 1000);
+        Log.print(F(" s ok/crc="));
+        Log.print(rxGainOk[m]);
+        Log.print('/');
+        Log.print(rxGainCrc[m]);
+        Log.print(' ');
+        Log.print(total ? rxGainOk[m] * 100 / total : 0);
+        Log.print('%');
+    }
+    Log.println();
+}
+
+// ── Packet sniffer ──────────────────────────────────────────────
+// With SNIFFER_MODE each good frame becomes a record in the log ring:
+//   0  C0 DA         sync, never in the boot text that comes first
+//   2  u16 LE        length of the rest
+//   4  u16 LE        sequence number, gaps are records lost
+//   6  u32 LE        RxDone time, µs (RX_STAMP_TIMER)
+//   10 LoRaTap v0    15-byte header, big-endian fields
+//   25 payload
+// At BW500/SF7 the shortest frame is ~6 ms on air, so at most ~4 kB/s
+// of records; USB full speed drains that with the ring nearly empty.
+#define SNIFF_SYNC0      0xC0
+#define SNIFF_SYNC1      0xDA
+#define SNIFF_HDR_LEN    10
+#define LORATAP_HDR_LEN  15
+
+static uint16_t sniffSeq = 0;
+
+// LoRaTap RSSI byte, dBm = -139 + value
+static uint8_t loratapRssi(float dbm)
+{
+    int32_t v = (int32_t)lroundf(dbm) + 139;
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Queue a received frame as a LoRaTap record
+//   Called before the AFC update, so the frequency is still the one
+//   the frame was received on. The SX1262 has no max-hold RSSI: the
+//   max and current fields carry the despread signal RSSI
+// ─────────────────────────────────────────────────────────────────
+static void sniffRecord(const RelayFrame *f)
+{
+    uint8_t rec[SNIFF_HDR_LEN + LORATAP_HDR_LEN + RX_MAX_LEN];
+    size_t len = LORATAP_HDR_LEN + f->rxLen;
+    uint32_t freqHz = (uint32_t)(LoRa_frequency * 1e6) + tempestTuneHz;
+    // below 0 dB SNR, LoRaTap takes the packet RSSI as -139 + value + SNR / 4
+    float pktRssi = f->info.rssi - (f->info.snr < 0 ? f->info.snr / 4 : 0);
+    int32_t snrQ2 = (int32_t)lroundf(f->info.snr * 4);
+
+    rec[0] = SNIFF_SYNC0;
+    rec[1] = SNIFF_SYNC1;
+    rec[2] = (uint8_t)(SNIFF_HDR_LEN - 4 + len);
+    rec[3] = (uint8_t)((SNIFF_HDR_LEN - 4 + len) >> 8);
+    rec[4] = (uint8_t)sniffSeq;
+    rec[5] = (uint8_t)(sniffSeq >> 8);
+    for (uint8_t i = 0; i < 4; i++) rec[6 + i] = (uint8_t)(f->rxStampUs >> (8 * i));
+
+    uint8_t *lt = &rec[SNIFF_HDR_LEN];
+    lt[0] = 0;                          // version
+    lt[1] = 0;
+    lt[2] = 0;
+    lt[3] = LORATAP_HDR_LEN;
+    for (uint8_t i = 0; i < 4; i++) lt[4 + i] = (uint8_t)(freqHz >> (24 - 8 * i));
+    lt[8] = 500 / 125;                  // bandwidth, 125 kHz steps
+    lt[9] = 7;                          // spreading factor
+    lt[10] = loratapRssi(pktRssi);
+    lt[11] = loratapRssi(f->info.signalRssi);
+    lt[12] = loratapRssi(f->info.signalRssi);
+    lt[13] = (uint8_t)(int8_t)(snrQ2 < -128 ? -128 : (snrQ2 > 127 ? 127 : snrQ2));
+    lt[14] = RADIOLIB_SX126X_SYNC_WORD_PRIVATE;
+    memcpy(&lt[LORATAP_HDR_LEN], f->rx, f->rxLen);
+
+    sniffSeq++;
+    Log.writeRecord(rec, SNIFF_HDR_LEN + len);
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Read a TEMPEST packet and hand it to the framing task (or, with
+// SNIFFER_MODE, to USB as a LoRaTap record)
+//   Runs in the radio task: only the SPI reads and the updates that
+//   retune the receiver happen here, so RX is re-armed right after
+// ─────────────────────────────────────────────────────────────────
+static uint32_t rxOverruns = 0;     // packets lost, every slot being built
+
+static void receiveFrame()
+{
+    // ── 1. Read TEMPEST-LoRaWAN packet into a pool slot ────────────
+    //    IRQ, buffer status, packet status and frequency error are
+    //    fetched together; everything below uses the cached f->info
+    RelayFrame *f = acquireFrame();
+    if (!f) {
+        // startReceive() clears the IRQ, the packet stays unread
+        // but it is in the buffer all the same
+        rxOverruns++;
+        preloadRxLanded(SIZE_MAX);
+        if (Serial) { Log.print(F("[TEMPEST-LoRa] Pool busy, packet lost, total ")); Log.println(rxOverruns); }
+        return;
+    }
+    f->rxStampUs = RX_STAMP_TIMER->CC[0];
+    uint32_t handledUs = rxStampNow() - f->rxStampUs;
+    int state = radio.readData(f->rx, RX_MAX_LEN, &f->info);
+    f->rxLen = (size_t)f->info.length;
+    f->rxMillis = millis();
+    preloadRxLanded((state == RADIOLIB_ERR_NONE || state == RADIOLIB_ERR_CRC_MISMATCH) ?
+                    f->rxLen : SIZE_MAX);
+
+    if (state != RADIOLIB_ERR_NONE) {
+        if (Serial) { Log.print(F("[TEMPEST-LoRa] Read error, code ")); Log.println(state); }
+        if (state == RADIOLIB_ERR_CRC_MISMATCH) {
+            rxGainUpdate(false, f->info.snr);
+            printRxGainStats();
+        }
+        return;
+    }
+
+    if (Serial) {
+        Log.print(F("[TEMPEST-LoRa] RxDone at "));
+        Log.print(f->rxStampUs);
+        Log.print(F(" us ("));
+        Log.print(rxStampHw ? F("PPI") : F("ISR"));
+        Log.print(F(" capture, handled "));
+        Log.print(handledUs);
+        Log.println(F(" us later)"));
+    }
+    if (SNIFFER_MODE) sniffRecord(f);
+    if (TEMPEST_AFC) tempestTrackOffset(f->info.freqError);
+    rxGainUpdate(true, f->info.snr);
+    printRxGainStats();
+
+    // the sniffer relays nothing: the slot is free again
+    if (SNIFFER_MODE) return;
+
+    // ── 2. The framing task builds the uplinks while RX goes on;
+    //       the queue holds every slot, so this never blocks
+    uint8_t slot = (uint8_t)(f - framePool);
+    f->pending = FRAME_IN_FLIGHT;
+    xQueueSend(frameQueue, &slot, 0);
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Route a received frame and build its uplinks in place
+//   Runs in the framing task. Nothing here touches the radio; the
+//   radio task preloads and queues the result in queueFrame()
+// ─────────────────────────────────────────────────────────────────
+static uint8_t framePackBuf[RX_MAX_LEN];    // framing task only
+
+static void buildFrame(RelayFrame *f)
+{
+    // ── 1. Print to Serial (only when USB connected) ────────────
+    int len = (int)f->rxLen;
+    float rssi = f->info.rssi;
+    float snr  = f->info.snr;
+    if (Serial) {
+        Log.print(F("[TEMPEST-LoRa] Received "));
+        Log.print(len);
+        Log.print(F(" bytes: "));
+        for (int i = 0; i < len; i++) {
+            if (f->rx[i] < 0x10) Log.print('0');
+            Log.print(f->rx[i], HEX);
+            Log.print(' ');
+        }
+        Log.println();
+        Log.print(F("[TEMPEST-LoRa] Text: "));
+        Log.write(f->rx, len);
+        Log.println();
+        Log.print(F("[TEMPEST-LoRa] RSSI: "));
+        Log.print(rssi);
+        Log.print(F(" dBm, SNR: "));
+        Log.print(snr);
+        Log.print(F(" dB, FreqErr: "));
+        Log.print(f->info.freqError, 0);
+        Log.println(F(" Hz"));
+    }
+
+    // ── Route by the relay rules; nothing is built for an uplink
+    //    the frame doesn't go to, and dropped frames free the slot
+    int8_t rule;
+    uint8_t route = relayRoute(f->rx, f->rxLen, rssi, snr, &rule);
+    f->route = route;
+    ruleHits[rule < 0 ? RELAY_RULE_COUNT : (size_t)rule]++;
+    if (Serial) {
+        Log.print(F("[Rules] "));
+        if (rule < 0) Log.print(F("default"));
+        else { Log.print(F("rule ")); Log.print(rule); }
+        Log.print(F(" -> "));
+        Log.print(route == ROUTE_BOTH ? F("both") : route == ROUTE_LORAWAN ? F("LoRaWAN") :
+                     route == ROUTE_MESH ? F("Meshtastic") : F("drop"));
+        Log.print(F(" (hits"));
+        for (size_t i = 0; i <= RELAY_RULE_COUNT; i++) {
+            Log.print(' ');
+            Log.print(ruleHits[i]);
+        }
+        Log.print(F(", dropped "));
+        Log.print(ruleDropped + (route == ROUTE_DROP));
+        Log.println(')');
+    }
+    if (route == ROUTE_DROP) {
+        ruleDropped++;
+        return;
+    }
+
+    // Show received text on display
+    {
+        char rxLine[22];
+        char budLine[22];
+        char rssiLine[22];
+        snprintf(rxLine, sizeof(rxLine), "RX: %.*s", (len > 16 ? 16 : len), f->rx);
+        budgetLine(budLine, sizeof(budLine), "Relay ");
+        snprintf(rssiLine, sizeof(rssiLine), "RSSI:%d SNR:%.1f",
+                 (int)rssi, (double)snr);
+        displayStatus("TEMPEST-LoRaWAN", rxLine, budLine, rssiLine);
+    }
+
+    // ── 2. Build the LoRaWAN uplink ──────────────────────────────
+    if (route & ROUTE_LORAWAN) {
+        f->lwFCnt = lorawanFCnt++;
+        f->lwLinkCheck = lorawanLinkCheckNext();
+        f->lwLen = buildLoRaWANUplink(f->lw, f->rx, f->rxLen,
+                                      LORAWAN_DEV_ADDR, f->lwFCnt, f->lwLinkCheck,
+                                      f->rxStampUs, &f->lwPackSaved);
+        f->lwDr = lorawanPickDr(f->lwLen);
+        f->toaUs[TXQ_LORAWAN] = uplinkToaUs(TXQ_LORAWAN, f->lwLen, f->lwDr);
+    }
+
+    // ── 3. Build the Meshtastic packet in place ──────────────────
+    if (route & ROUTE_MESH) {
+        f->meshId = packetIdCounter++;
+        f->meshLen = buildMeshtasticPacket(f->mesh, f->rx, f->rxLen, f->meshId, framePackBuf,
+                                           &f->meshPreset, &f->meshPackSaved);
+        f->toaUs[TXQ_MESH] = uplinkToaUs(TXQ_MESH, f->meshLen, f->meshPreset);
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Queue a frame back from the framing task
+//   The LoRaWAN uplink is preloaded into the TX region while the
+//   radio is still listening (LR-FHSS frames are encoded at TX time,
+//   no preload)
+// ─────────────────────────────────────────────────────────────────
+static void queueFrame(RelayFrame *f)
+{
+    f->pending &= ~FRAME_IN_FLIGHT;
+    if (f->route & ROUTE_LORAWAN) {
+        preloadedFrame = (!LORAWAN_UPLINK_LRFHSS &&
+                          preloadTx(&f->lw[LW_B0_LEN], f->lwLen)) ? f : NULL;
+        txqPush(TXQ_LORAWAN, f);
+    }
+    if (f->route & ROUTE_MESH) txqPush(TXQ_MESH, f);
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Parse a downlink for LinkCheckAns
+//   `buf` holds LW_B0_LEN bytes of MIC headroom, then the PHYPayload.
+//   MAC commands are read from FOpts, or from an FPort 0 FRMPayload;
+//   their lengths come from RadioLib's MacTable so unrelated commands
+//   in front are skipped. The relay has no downlink FCnt state, so
+//   the upper 16 bits of FCntDown are taken as 0.
+//   Returns true if a LinkCheckAns was found
+// ─────────────────────────────────────────────────────────────────
+static bool lorawanParseDownlink(uint8_t *buf, size_t len, uint8_t dr)
+{
+    uint8_t *in = &buf[LW_B0_LEN];
+    if (len < 12) return false;     // MHDR, FHDR, MIC
+
+    // Unconfirmed / Confirmed Data Down for our DevAddr
+    uint8_t mtype = in[0] & 0xE0;
+    if (mtype != 0x60 && mtype != 0xA0) return false;
+    uint32_t devAddr = (uint32_t)in[1] | ((uint32_t)in[2] << 8) |
+                       ((uint32_t)in[3] << 16) | ((uint32_t)in[4] << 24);
+    if (devAddr != LORAWAN_DEV_ADDR) return false;
+
+    uint8_t fOptsLen = in[5] & 0x0F;
+    uint16_t fCnt = (uint16_t)in[6] | ((uint16_t)in[7] << 8);
+    if (8 + (size_t)fOptsLen + 4 > len) return false;
+
+    uint8_t mic[4];
+    lorawanMic(buf, len - 4, 1, devAddr, fCnt, mic);
+    if (memcmp(mic, &in[len - 4], 4) != 0) return false;
+
+    uint8_t *cmds = &in[8];
+    size_t cmdsLen = fOptsLen;
+    if (!fOptsLen && len > 12 && in[8] == 0) {
+        cmds = &in[9];
+        cmdsLen = len - 13;
+        aes128ctr_lorawan(nwkSKey, 1, devAddr, fCnt, cmds, cmdsLen);
+    }
+
+    for (size_t i = 0; i < cmdsLen; ) {
+        uint8_t cid = cmds[i++];
+        const LoRaWANMacCommand_t *cmd = NULL;
+        for (uint8_t k = 0; k < RADIOLIB_LORAWAN_NUM_MAC_COMMANDS; k++) {
+            if (MacTable[k].cid == cid) { cmd = &MacTable[k]; break; }
+        }
+        // past an unknown command the rest can't be framed
+        if (!cmd || i + cmd->lenDn > cmdsLen) break;
+
+        if (cid == RADIOLIB_LORAWAN_MAC_LINK_CHECK) {
+            int16_t margin = cmds[i];
+            lorawanMargin = (dr == 4) ? margin + LW_DR4_PENALTY_DB : margin;
+            lorawanGwCnt = cmds[i + 1];
+            return true;
+        }
+        i += cmd->lenDn;
+    }
+    return false;
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Listen in RX1 for the answer to a LinkCheckReq
+//   US915 RX1 opens 1 s after the end of the uplink, on
+//   923.3 + 0.6 * (channel % 8) MHz at DR13 (SF7/BW500, inverted IQ)
+//   for both DR3 and DR4 uplinks. TEMPEST RX is paused meanwhile,
+//   which is why the request only rides along now and then.
+//   Returns true if a LinkCheckAns arrived
+// ─────────────────────────────────────────────────────────────────
+#define LW_RX1_DELAY_MS   1000
+#define LW_RX1_LEAD_MS    20        // open early for clock error
+#define LW_RX1_WINDOW_MS  100
+
+static uint8_t lorawanDown[LW_B0_LEN + RX_MAX_LEN];
+
+static bool lorawanRx1(uint32_t txEndMillis, uint8_t channel, uint8_t dr)
+{
+    radio.setFrequency(923.3 + 0.6 * (channel % 8));
+    radio.setBandwidth(500);
+    radio.setSpreadingFactor(7);
+    radio.setCodingRate(5);
+    radio.setPreambleLength(8);
+    radio.setSyncWord(0x34);
+    radio.setCRC(0);                // downlinks carry no payload CRC
+    radio.invertIQ(true);
+
+    uint32_t elapsed = millis() - txEndMillis;
+    if (elapsed < LW_RX1_DELAY_MS - LW_RX1_LEAD_MS)
+        radioDelay(LW_RX1_DELAY_MS - LW_RX1_LEAD_MS - elapsed);
+
+    // asleep through the window, same as receive() with its timeout
+    int state = radio.startReceive((uint32_t)LW_RX1_WINDOW_MS * 64);     // 15.625 µs steps
+    if (state == RADIOLIB_ERR_NONE && !radioWaitDio1(LW_RX1_WINDOW_MS)) state = RADIOLIB_ERR_RX_TIMEOUT;
+    radio.standby();
+    if (state == RADIOLIB_ERR_NONE) state = radio.readData(&lorawanDown[LW_B0_LEN], 0);
+    else radio.finishReceive();
+    size_t len = (state == RADIOLIB_ERR_NONE) ? radio.getPacketLength(false) : 0;
+    radio.invertIQ(false);
+
+    if (len && lorawanParseDownlink(lorawanDown, len, dr)) {
+        lorawanLinkCheckMissed = 0;
+        if (Serial) {
+            Log.print(F("[LoRaWAN] LinkCheckAns: margin "));
+            Log.print(lorawanMargin - (dr == 4 ? LW_DR4_PENALTY_DB : 0));
+            Log.print(F(" dB at DR"));
+            Log.print(dr);
+            Log.print(F(", "));
+            Log.print(lorawanGwCnt);
+            Log.println(F(" gateway(s)"));
+        }
+        return true;
+    }
+
+    if (++lorawanLinkCheckMissed >= LW_LINKCHECK_MAX_MISS)
+        lorawanMargin = LW_MARGIN_UNKNOWN;
+    if (Serial) {
+        Log.print(F("[LoRaWAN] No LinkCheckAns ("));
+        Log.print(lorawanLinkCheckMissed);
+        Log.println(F(" missed)"));
+    }
+    return false;
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Pick the 125 kHz channel of the next DR3 uplink
+// ─────────────────────────────────────────────────────────────────
+static uint8_t lorawanPickChannel()
+{
+    uint32_t now = millis();
+    uint16_t weight[LW_CH_COUNT];
+    uint32_t total = 0;
+
+    for (uint8_t ch = 0; ch < LW_CH_COUNT; ch++) {
+        LwChannel &c = lorawanCh[ch];
+        // back from the blacklist on probation, halfway to blocked
+        if (c.blocked && (int32_t)(now - c.blockedUntil) >= 0) {
+            c.blocked = false;
+            c.penalty = LW_CH_BLOCK_AT / 2;
+        }
+        weight[ch] = (c.blocked || ch == lorawanLastCh) ? 0 : 256 - c.penalty;
+        total += weight[ch];
+    }
+
+    // at least three channels are open, so total is never 0
+    uint32_t r = (uint32_t)random((long)total);
+    uint8_t ch = 0;
+    while (r >= weight[ch]) r -= weight[ch++];
+
+    lorawanLastCh = ch;
+    lorawanCh[ch].used++;
+    return ch;
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Feed an uplink outcome (LW_CH_*) into a channel's penalty
+// ─────────────────────────────────────────────────────────────────
+static void lorawanChannelEvent(uint8_t ch, uint8_t ev)
+{
+    LwChannel &c = lorawanCh[ch];
+    switch (ev) {
+    case LW_CH_CLEAR:  c.penalty -= c.penalty / 16;                      break;
+    case LW_CH_ACK:    c.penalty -= c.penalty / 2;  c.acked++;           break;
+    case LW_CH_BUSY:   c.penalty += (255 - c.penalty) / 4;  c.busy++;    break;
+    case LW_CH_FAILED: c.penalty += (255 - c.penalty) / 4;  c.failed++;  break;
+    case LW_CH_NO_ACK: c.penalty += (255 - c.penalty) / 8;               break;
+    }
+    if (c.blocked || c.penalty < LW_CH_BLOCK_AT) return;
+
+    uint8_t blocked = 0;
+    for (uint8_t i = 0; i < LW_CH_COUNT; i++) blocked += lorawanCh[i].blocked;
+    if (blocked >= LW_CH_MAX_BLOCKED) return;
+
+    c.blocked = true;
+    c.blockedUntil = millis() + LW_CH_BLOCK_MS;
+    if (Serial) {
+        Log.print(F("[LoRaWAN] Blacklisted channel "));
+        Log.print(8 + ch);
+        Log.print(F(" for "));
+        Log.print(LW_CH_BLOCK_MS / 1000);
+        Log.println(F(" s"));
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Per-channel LoRaWAN counters
+//   channel:used/busy/failed/acked, quality %, x = blacklisted
+// ─────────────────────────────────────────────────────────────────
+static void printLoRaWANChannels()
+{
+    if (!Serial) return;
+    Log.print(F("[LoRaWAN] Channels"));
+    for (uint8_t ch = 0; ch < LW_CH_COUNT; ch++) {
+        const LwChannel &c = lorawanCh[ch];
+        Log.print(' ');
+        Log.print(8 + ch);
+        Log.print(':');
+        Log.print(c.used);
+        Log.print('/');
+        Log.print(c.busy);
+        Log.print('/');
+        Log.print(c.failed);
+        Log.print('/');
+        Log.print(c.acked);
+        Log.print(' ');
+        Log.print((255 - c.penalty) * 100 / 255);
+        Log.print('%');
+        if (c.blocked) Log.print('x');
+    }
+    Log.println();
+}
+
+// ─────────────────────────────────────────────────────────────────
+// LoRaWAN TX of a queued frame
+//   Returns the TX state, RADIOLIB_LORA_DETECTED if the CAD found
+//   the channel busy and nothing was sent
+// ─────────────────────────────────────────────────────────────────
+static int sendLoRaWAN(RelayFrame *f)
+{
+    // DR3 picks among the 125 kHz channels, DR4 and LR-FHSS use ch 65
+    uint8_t channel = 65;
+    int8_t ch = -1;
+    float lwFreq = lorawanWideFreq;
+    if (f->lwDr == 3) {
+        ch = (int8_t)lorawanPickChannel();
+        channel = 8 + ch;
+        lwFreq = lorawanFreqs[ch];
+    }
+
+    if (Serial) {
+        Log.print(F("[LoRaWAN] Sending "));
+        Log.print(f->lwLen);
+        Log.print(F(" bytes on "));
+        Log.print(lwFreq, 1);
+        Log.print(F(" MHz (DR"));
+        Log.print(f->lwDr);
+        Log.print(F(", FCnt="));
+        Log.print(f->lwFCnt);
+        if (f->lwLinkCheck) Log.print(F(", LinkCheckReq"));
+        if (f->lwPackSaved) {
+            Log.print(F(", packed -"));
+            Log.print(f->lwPackSaved);
+        }
+        Log.print(F(") ... "));
+    }
+
+    int state;
+    if (LORAWAN_UPLINK_LRFHSS) {
+        state = sendLrFhss(&f->lw[LW_B0_LEN], f->lwLen);
+    } else {
+        configLoRaWAN(lwFreq, f->lwDr);
+        if (lbtBusy(TXQ_LORAWAN)) {
+            if (Serial) Log.println(F("channel busy"));
+            if (ch >= 0) lorawanChannelEvent(ch, LW_CH_BUSY);
+            return RADIOLIB_LORA_DETECTED;
+        }
+        state = sendTx(&f->lw[LW_B0_LEN], f->lwLen, preloadedFrame == f);
+    }
+    uint32_t txEndMillis = millis();
+
+    if (state != RADIOLIB_ERR_NONE) {
+        if (Serial) { Log.print(F("failed, code ")); Log.println(state); }
+        if (ch >= 0) lorawanChannelEvent(ch, LW_CH_FAILED);
+        return state;
+    }
+    if (Serial) Log.println(F("OK"));
+
+    if (f->lwPackSaved) {
+        lorawanPackedFrames++;
+        lorawanPackedBytes += f->lwPackSaved;
+    }
+    if (LORAWAN_PACK_PAYLOAD && Serial) {
+        Log.print(F("[LoRaWAN] packed="));
+        Log.print(lorawanPackedFrames);
+        Log.print(F(" saved="));
+        Log.print(lorawanPackedBytes);
+        Log.println(F(" bytes"));
+    }
+
+    if (!LORAWAN_UPLINK_LRFHSS) {
+        uint32_t saved = 0;
+        if (f->lwDr == 4) saved = lorawanToaUs(3, f->lwLen) - lorawanToaUs(4, f->lwLen);
+        lorawanDrSent[f->lwDr == 4]++;
+        lorawanSavedUs += saved;
+        if (Serial) {
+            Log.print(F("[LoRaWAN] DR"));
+            Log.print(f->lwDr);
+            Log.print(F(" saved "));
+            Log.print(saved / 1000);
+            Log.print(F(" ms vs DR3; DR3/DR4 uplinks="));
+            Log.print(lorawanDrSent[0]);
+            Log.print('/');
+            Log.print(lorawanDrSent[1]);
+            Log.print(F(" saved="));
+            Log.print(lorawanSavedUs / 1000);
+            Log.print(F(" ms margin(DR3)="));
+            if (lorawanMargin == LW_MARGIN_UNKNOWN) Log.println('?');
+            else { Log.print(lorawanMargin); Log.println(F(" dB")); }
+        }
+    }
+
+    if (ch >= 0) {
+        uint8_t ev = LW_CH_CLEAR;
+        if (f->lwLinkCheck) ev = lorawanRx1(txEndMillis, channel, f->lwDr) ? LW_CH_ACK : LW_CH_NO_ACK;
+        lorawanChannelEvent(ch, ev);
+        printLoRaWANChannels();
+    } else if (f->lwLinkCheck) {
+        lorawanRx1(txEndMillis, channel, f->lwDr);
+    }
+    return state;
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Per-preset Meshtastic counters
+// ─────────────────────────────────────────────────────────────────
+static void printMeshStats()
+{
+    if (!Serial) return;
+    for (uint8_t i = 0; i < MESH_ENABLED_COUNT; i++) {
+        uint8_t p = meshEnabled[i];
+        const MeshPresetStats &ms = meshStats[p];
+        Log.print(F("[Meshtastic] "));
+        Log.print(meshPresets[p].name);
+        Log.print(F(" @ "));
+        Log.print(meshPresets[p].freq, 3);
+        Log.print(F(" MHz: sent="));
+        Log.print(ms.sent);
+        Log.print(F(" failed="));
+        Log.print(ms.failed);
+        Log.print(F(" airtime="));
+        Log.print(ms.airtimeMs);
+        Log.print(F(" ms busy="));
+        Log.print((unsigned)ms.busyQ8 * 100 / 256);
+        Log.println('%');
+    }
+    if (MESH_PACK_TEXT) {
+        Log.print(F("[Meshtastic] packed="));
+        Log.print(meshPackedFrames);
+        Log.print(F(" saved="));
+        Log.print(meshPackedBytes);
+        Log.println(F(" bytes"));
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Meshtastic TX of a queued frame
+//   Returns the TX state, RADIOLIB_LORA_DETECTED if the CAD found
+//   the channel busy and nothing was sent
+// ─────────────────────────────────────────────────────────────────
+static int sendMeshtastic(RelayFrame *f)
+{
+    if (Serial) {
+        Log.print(F("[Meshtastic] Sending "));
+        Log.print(f->meshLen);
+        Log.print(F(" bytes on "));
+        Log.print(meshPresets[f->meshPreset].name);
+        if (f->meshPackSaved) {
+            Log.print(F(", packed -"));
+            Log.print(f->meshPackSaved);
+        }
+        Log.print(F(" (id=0x"));
+        Log.print(f->meshId, HEX);
+        Log.println(F(")"));
+        Log.print(F("[Meshtastic] Packet: "));
+        for (size_t i = 0; i < f->meshLen; i++) {
+            if (f->mesh[i] < 0x10) Log.print('0');
+            Log.print(f->mesh[i], HEX);
+            Log.print(' ');
+        }
+        Log.println();
+        Log.print(F("[Meshtastic] TX ... "));
+    }
+
+    configMeshtastic(f->meshPreset);
+    if (lbtBusy(TXQ_MESH)) {
+        if (Serial) Log.println(F("channel busy"));
+        return RADIOLIB_LORA_DETECTED;
+    }
+    int state = sendTx(f->mesh, f->meshLen, false);
+
+    MeshPresetStats &ms = meshStats[f->meshPreset];
+    ms.airtimeMs += f->toaUs[TXQ_MESH] / 1000;
+    if (state == RADIOLIB_ERR_NONE) {
+        if (Serial) Log.println(F("OK"));
+        relayCount++;
+        ms.sent++;
+        if (f->meshPackSaved) {
+            meshPackedFrames++;
+            meshPackedBytes += f->meshPackSaved;
+        }
+    } else {
+        if (Serial) { Log.print(F("failed, code ")); Log.println(state); }
+        ms.failed++;
+    }
+
+    meshSampleBusy();
+    printMeshStats();
+
+    // Show result on display
+    {
+        int len = (int)f->rxLen;
+        char rxLine[22];
+        char txLine[22];
+        char cntLine[22];
+        snprintf(rxLine, sizeof(rxLine), "RX: %.*s", (len > 16 ? 16 : len), f->rx);
+        budgetLine(txLine, sizeof(txLine), state == RADIOLIB_ERR_NONE ? "TX OK " : "TX ERR ");
+        snprintf(cntLine, sizeof(cntLine), "Relayed:%lu %s", (unsigned long)relayCount,
+                 meshPresets[f->meshPreset].name);
+        displayStatus("TEMPEST-LoRaWAN", rxLine, txLine, cntLine);
+    }
+    return state;
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Merge frames queued behind the head of `q` into the head's uplink
+//   Texts are joined with '\n' while they fit the queue's payload
+//   limit and the merged airtime still fits the budget. The head
+//   keeps its FCnt / packet id; merged frames leave this queue only.
+//   Runs in the radio task, which can preempt the framing task in the
+//   middle of a build, so it packs into its own buffer
+// ─────────────────────────────────────────────────────────────────
+static uint8_t mergeBuf[RX_MAX_LEN];
+static uint8_t mergePackBuf[RX_MAX_LEN];
+
+static void txqCoalesce(uint8_t q)
+{
+    TxQueue &tq = txQueues[q];
+    RelayFrame *f = txqHead(q);
+    size_t len = f->rxLen;
+    if (tq.count < 2 || len > tq.maxText) return;
+
+    uint8_t merged = 0;
+    memcpy(mergeBuf, f->rx, len);
+    for (uint8_t i = 1; i < tq.count; i++) {
+        const RelayFrame *g = &framePool[tq.slot[(tq.head + i) % RELAY_POOL_SIZE]];
+        size_t next = len + 1 + g->rxLen;
+        if (next > tq.maxText) break;
+        size_t fOptsLen = (q == TXQ_LORAWAN && f->lwLinkCheck) ? 1 : 0;
+        size_t upLen = uplinkLen(q, next) + fOptsLen;
+        uint8_t rate = (q == TXQ_MESH) ? meshPickPreset(upLen) : lorawanPickDr(upLen);
+        if (uplinkToaUs(q, upLen, rate) > tq.tokensUs) break;
+        mergeBuf[len] = '\n';
+        memcpy(&mergeBuf[len + 1], g->rx, g->rxLen);
+        len = next;
+        merged++;
+    }
+    if (!merged) return;
+
+    if (q == TXQ_LORAWAN) {
+        f->lwLen = buildLoRaWANUplink(f->lw, mergeBuf, len,
+                                      LORAWAN_DEV_ADDR, f->lwFCnt, f->lwLinkCheck,
+                                      f->rxStampUs, &f->lwPackSaved);
+        f->lwDr = lorawanPickDr(f->lwLen);
+        if (preloadedFrame == f) preloadedFrame = NULL;
+        f->toaUs[q] = uplinkToaUs(q, f->lwLen, f->lwDr);
+    } else {
+        f->meshLen = buildMeshtasticPacket(f->mesh, mergeBuf, len, f->meshId, mergePackBuf,
+                                           &f->meshPreset, &f->meshPackSaved);
+        f->toaUs[q] = uplinkToaUs(q, f->meshLen, f->meshPreset);
+    }
+
+    // merged frames sit right behind the head: release them and
+    // move the head slot into the last one
+    for (uint8_t i = 1; i <= merged; i++)
+        framePool[tq.slot[(tq.head + i) % RELAY_POOL_SIZE]].pending &= ~(1 << q);
+    uint8_t headSlot = tq.slot[tq.head];
+    tq.head = (tq.head + merged) % RELAY_POOL_SIZE;
+    tq.slot[tq.head] = headSlot;
+    tq.count -= merged;
+    tq.coalesced += merged;
+
+    if (Serial) {
+        Log.print(F("[Sched] Merged "));
+        Log.print(merged + 1);
+        Log.print(' ');
+        Log.print(tq.name);
+        Log.println(F(" frames"));
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Time until a queued uplink may be sent
+//   A head out of airtime waits for its bucket, one in a contention
+//   window for the window's end; 0 if a head is ready now. Lets the
+//   radio task sleep through the wait instead of polling
+// ─────────────────────────────────────────────────────────────────
+static uint32_t txqWaitMs(uint32_t now)
+{
+    uint32_t wait = UINT32_MAX;
+    for (uint8_t q = 0; q < TXQ_COUNT; q++) {
+        TxQueue &tq = txQueues[q];
+        if (!tq.count) continue;
+
+        RelayFrame *h = txqHead(q);
+        uint32_t w = 0;
+        if (h->toaUs[q] > tq.tokensUs) {
+            w = (uint32_t)((uint64_t)(h->toaUs[q] - tq.tokensUs) * 3600 /
+                           tq.budgetMsPerHour) + 1;
+        } else if (tq.lbt && tq.lbtSlot == (int8_t)(h - framePool) &&
+                   (int32_t)(tq.lbtUntil - now) > 0) {
+            w = tq.lbtUntil - now;
+        }
+        if (w < wait) wait = w;
+    }
+    return wait;
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Send the next queued uplink, if any
+//   Returns true if the radio left RX
+// ─────────────────────────────────────────────────────────────────
+static uint32_t radioTxUs = 0;      // airtime of all uplinks
+
+static bool serviceTxQueues()
+{
+    uint32_t now = millis();
+    int8_t best = -1;
+    for (uint8_t q = 0; q < TXQ_COUNT; q++) {
+        TxQueue &tq = txQueues[q];
+        txqRefill(q, now);
+
+        // drop heads that can no longer finish before their deadline,
+        // or could never be sent at all
+        while (tq.count) {
+            RelayFrame *f = txqHead(q);
+            if (now - f->rxMillis + f->toaUs[q] / 1000 > tq.maxAgeMs) {
+                txqDrop(q, F("stale"));
+            } else if (f->toaUs[q] > tq.burstMs * 1000UL) {
+                txqDrop(q, F("over burst budget"));
+            } else if (q == TXQ_LORAWAN && f->lwDr == 3 &&
+                       f->toaUs[q] > LORAWAN_DWELL_US) {
+                txqDrop(q, F("dwell time"));
+            } else {
+                break;
+            }
+        }
+        if (!tq.count) continue;
+
+        // out of airtime: leave it queued until the bucket refills
+        RelayFrame *h = txqHead(q);
+        if (h->toaUs[q] > tq.tokensUs) {
+            int8_t slot = (int8_t)(h - framePool);
+            if (tq.deferredSlot != slot) {
+                tq.deferredSlot = slot;
+                tq.deferred++;
+                if (Serial) {
+                    Log.print(F("[Sched] Deferred "));
+                    Log.print(tq.name);
+                    Log.print(F(" frame, needs "));
+                    Log.print(h->toaUs[q] / 1000);
+                    Log.print(F(" ms of airtime, "));
+                    Log.print(tq.tokensUs / 1000);
+                    Log.println(F(" ms left"));
+                }
+            }
+            continue;
+        }
+
+        // listen before talk: a new head starts its contention window,
+        // and nobody transmits before theirs has run out
+        if (tq.lbt) {
+            if (tq.lbtSlot != (int8_t)(h - framePool)) {
+                tq.lbtTries = 0;
+                lbtArm(q, now);
+            }
+            if ((int32_t)(now - tq.lbtUntil) < 0) continue;
+        }
+
+        if (best < 0 || tq.priority < txQueues[best].priority ||
+            (tq.priority == txQueues[best].priority &&
+             txqHead(q)->toaUs[q] < txqHead(best)->toaUs[best])) {
+            best = q;
+        }
+    }
+    if (best < 0) return false;
+
+    txqCoalesce(best);
+    RelayFrame *f = txqHead(best);
+    int state = (best == TXQ_LORAWAN) ? sendLoRaWAN(f) : sendMeshtastic(f);
+
+    // channel busy: nothing was sent, the head stays queued
+    if (state == RADIOLIB_LORA_DETECTED) {
+        lbtBackoff(best);
+        return true;
+    }
+    preloadedFrame = NULL;  // TX region is stale after any transmission
+    bool ok = state == RADIOLIB_ERR_NONE;
+
+    // airtime is spent whether or not the TX succeeded
+    TxQueue &tq = txQueues[best];
+    tq.tokensUs -= f->toaUs[best];
+    radioTxUs += f->toaUs[best];
+    if (ok) {
+        uint32_t latency = millis() - f->rxMillis;
+        tq.sent++;
+        tq.latencySumMs += latency;
+        if (latency > tq.latencyMaxMs) tq.latencyMaxMs = latency;
+    } else {
+        tq.failed++;
+    }
+    txqPop(best);
+    printTxqStats();
+    return true;
+}
+
+// ── Memory instrumentation ──────────────────────────────────────
+// FreeRTOS paints every task stack and uxTaskGetStackHighWaterMark()
+// measures it; this adds the main stack the ISRs run on, painted at
+// boot and scanned for the deepest overwritten word, and the C++
+// heap. operator new / delete are wrapped to count every C++
+// allocation, in the core and libraries as well as the relay's own.
+// Most come from RadioLib: its Module and HAL, and a buffer pair per
+// SPI command unless built with RADIOLIB_STATIC_ONLY.
+#define STACK_PAINT  0xA5A5A5A5UL       // FreeRTOS's fill byte
+
+extern uint32_t __StackLimit[];         // main stack, from the linker script
+extern uint32_t __StackTop[];
+
+struct HeapStats {
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t inUse;                     // bytes
+    uint32_t peak;
+};
+
+static HeapStats heapStats;
+
+// Allocations carry their size in front, 8 bytes to keep alignment
+static void *heapAlloc(size_t size)
+{
+    uint32_t *p = (uint32_t *)malloc(size + 8);
+    if (!p) return NULL;
+    p[0] = (uint32_t)size;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    heapStats.allocs++;
+    heapStats.inUse += size;
+    if (heapStats.inUse > heapStats.peak) heapStats.peak = heapStats.inUse;
+    __set_PRIMASK(primask);
+    return &p[2];
+}
+
+static void heapFree(void *ptr)
+{
+    if (!ptr) return;
+    uint32_t *p = (uint32_t *)ptr - 2;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    heapStats.frees++;
+    heapStats.inUse -= p[0];
+    __set_PRIMASK(primask);
+    free(p);
+}
+
+void *operator new(size_t size) { return heapAlloc(size); }
+void *operator new[](size_t size) { return heapAlloc(size); }
+void operator delete(void *p) noexcept { heapFree(p); }
+void operator delete[](void *p) noexcept { heapFree(p); }
+void operator delete(void *p, size_t) noexcept { heapFree(p); }
+void operator delete[](void *p, size_t) noexcept { heapFree(p); }
+
+// ─────────────────────────────────────────────────────────────────
+// Paint the main stack
+//   Called from thread mode, where only exceptions use the main
+//   stack, so everything below the current MSP is free; interrupts
+//   stay off meanwhile so none lands on a half-painted stack
+// ─────────────────────────────────────────────────────────────────
+static void mspPaint()
+{
+    __disable_irq();
+    for (uint32_t *w = __StackLimit; w < (uint32_t *)__get_MSP(); w++) *w = STACK_PAINT;
+    __enable_irq();
+}
+
+// Main stack never used so far, in bytes
+static uint32_t mspFree()
+{
+    uint32_t *w = __StackLimit;
+    while (w < __StackTop && *w == STACK_PAINT) w++;
+    return (uint32_t)(w - __StackLimit) * sizeof(uint32_t);
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Print the stack and heap high-water marks
+//   Runs in loop(), so the loop task's own stack is measured too
+// ─────────────────────────────────────────────────────────────────
+static void printMemoryStats()
+{
+    if (!Serial) return;
+    struct mallinfo mi = mallinfo();
+
+    Log.print(F("[Memory] loop stack free "));
+    Log.print((uint32_t)uxTaskGetStackHighWaterMark(NULL) * sizeof(StackType_t));
+    Log.print(F(" B, ISR stack free "));
+    Log.print(mspFree());
+    Log.print(F(" of "));
+    Log.print((uint32_t)(__StackTop - __StackLimit) * sizeof(uint32_t));
+    Log.println(F(" B"));
+    Log.print(F("[Memory] C++ heap "));
+    Log.print(heapStats.inUse);
+    Log.print(F(" B in use, peak "));
+    Log.print(heapStats.peak);
+    Log.print(F(" B, "));
+    Log.print(heapStats.allocs);
+    Log.print(F(" allocs / "));
+    Log.print(heapStats.frees);
+    Log.print(F(" frees; malloc arena "));
+    Log.print((uint32_t)mi.arena);
+    Log.print(F(" B, "));
+    Log.print((uint32_t)mi.uordblks);
+    Log.println(F(" B in use"));
+}
+
+// ── Tasks ───────────────────────────────────────────────────────
+// The radio task owns the SX1262 and the output scheduler and runs
+// above everything else; the framing task routes, packs and encrypts;
+// the display and log tasks do the slow I2C and USB transfers at the
+// lowest priority. Busy time is summed per task with micros() around
+// each unit of work (the core isn't built with FreeRTOS run-time
+// stats); loop() reports it with the stack high-water marks.
+//
+// Every task blocks until it has work, so between packets the core's
+// tickless idle keeps the CPU asleep (sd_app_evt_wait, or WFE without
+// the SoftDevice) until DIO1 or the next timed wake-up. The summed
+// busy time doubles as the awake time of the charge estimate; the
+// core's USB task and SoftDevice aren't counted.
+#define TASK_REPORT_MS    60000
+
+enum { TASK_RADIO = 0, TASK_FRAME, TASK_DISPLAY, TASK_LOG, TASK_COUNT };
+
+struct TaskSlot {
+    const char  *name;
+    TaskFunction_t fn;
+    uint16_t    stackWords;
+    UBaseType_t priority;
+    TaskHandle_t handle;
+    uint32_t    busyUs;
+    uint32_t    lastBusyUs;         // at the previous report
+};
+
+static void radioTask(void *);
+static void frameTask(void *);
+static void displayTask(void *);
+static void logTask(void *);
+
+static TaskSlot tasks[TASK_COUNT] = {
+    { "radio",   radioTask,   1024, TASK_PRIO_HIGH   },
+    { "frame",   frameTask,   768,  TASK_PRIO_NORMAL },
+    { "display", displayTask, 384,  TASK_PRIO_LOW    },
+    { "log",     logTask,     256,  TASK_PRIO_LOW    },
+};
+
+static uint32_t taskReportMillis = 0;
+
+// Charge estimate since boot, see POWER_* in boards.h
+static uint32_t powerAwakeMs = 0;
+static uint32_t powerSleepMs = 0;
+static uint64_t powerCharge = 0;            // µA·µs
+static uint32_t powerLastTxUs = 0;
+static uint32_t powerLastOledMs = 0;
+
+// ─────────────────────────────────────────────────────────────────
+// Radio task
+//   Sleeps until DIO1, a built frame, the next noise sample, or the
+//   time a waiting uplink may go. Sends at most one uplink per pass,
+//   then listens again so TEMPEST packets are not missed between
+//   uplinks
+// ─────────────────────────────────────────────────────────────────
+static void radioTask(void *)
+{
+    for (;;) {
+        uint32_t waitMs = RX_NOISE_EVERY_MS;
+        if (txqPending()) waitMs = min(waitMs, txqWaitMs(millis()));
+        // radioWaitDio1() may have taken the framing task's notification
+        if (uxQueueMessagesWaiting(builtQueue)) waitMs = 0;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+        uint32_t t0 = micros();
+        uint32_t slept = radioSleptUs;
+
+        bool rxDone = receivedFlag;
+        if (!rxDone) rxSampleNoise();
+        if (!rxDone && !uxQueueMessagesWaiting(builtQueue) && !txqPending()) {
+            tasks[TASK_RADIO].busyUs += micros() - t0;
+            continue;
+        }
+
+        // Disable interrupt while processing
+        enableInterrupt = false;
+
+        if (rxDone) {
+            receivedFlag = false;
+            receiveFrame();
+        }
+
+        uint8_t slot;
+        while (xQueueReceive(builtQueue, &slot, 0) == pdTRUE)
+            queueFrame(&framePool[slot]);
+
+        bool txDone = serviceTxQueues();
+
+        // ── Switch back to TEMPEST-LoRaWAN and resume listening ────
+        if (rxDone || txDone) {
+            configTempest();
+            radio.setDio1Action(setFlag);
+            rxStampHook();
+            radio.startReceive();
+        }
+        enableInterrupt = true;
+
+        // an RxDone while interrupts were off left DIO1 high with no
+        // edge to come: read the packet on the next pass
+        if (digitalRead(RADIO_DIO1_PIN) && !receivedFlag) {
+            receivedFlag = true;
+            xTaskNotifyGive(radioTaskHandle);
+        }
+        tasks[TASK_RADIO].busyUs += micros() - t0 - (radioSleptUs - slept);
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Framing task: build each received frame, give it back to the radio
+// ─────────────────────────────────────────────────────────────────
+static void frameTask(void *)
+{
+    uint8_t slot;
+    for (;;) {
+        xQueueReceive(frameQueue, &slot, portMAX_DELAY);
+        uint32_t t0 = micros();
+        buildFrame(&framePool[slot]);
+        xQueueSend(builtQueue, &slot, 0);
+        xTaskNotifyGive(radioTaskHandle);
+        tasks[TASK_FRAME].busyUs += micros() - t0;
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Display task: draw the latest status text
+//   Powers the OLED down when nothing new came for DISPLAY_SLEEP_MS,
+//   and back up with the next text
+// ─────────────────────────────────────────────────────────────────
+static void displayTask(void *)
+{
+    DisplayMsg m;
+    for (;;) {
+        TickType_t wait = (DISPLAY_SLEEP_MS && displayOn) ?
+                          pdMS_TO_TICKS(DISPLAY_SLEEP_MS) : portMAX_DELAY;
+        bool news = xQueueReceive(displayQueue, &m, wait) == pdTRUE;
+        uint32_t t0 = micros();
+        if (!news) {
+            u8g2.setPowerSave(1);
+            displayOnMs += millis() - displayOnSince;
+            displayOn = false;
+        } else {
+            if (!displayOn) {
+                u8g2.setPowerSave(0);
+                displayOnSince = millis();
+                displayOn = true;
+            }
+            displayDraw(m);
+        }
+        tasks[TASK_DISPLAY].busyUs += micros() - t0;
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Log task: feed the log ring to USB
+//   Busy time includes waiting for the host to take the data
+// ─────────────────────────────────────────────────────────────────
+static void logTask(void *)
+{
+    static uint8_t chunk[64];
+    for (;;) {
+        size_t n = Log.drain(chunk, sizeof(chunk));
+        if (!n) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        uint32_t t0 = micros();
+        if (Serial) Serial.write(chunk, n);
+        tasks[TASK_LOG].busyUs += micros() - t0;
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Create the queues and start the tasks
+//   From here on the radio is only touched by the radio task
+// ─────────────────────────────────────────────────────────────────
+static void startTasks()
+{
+    frameQueue = xQueueCreate(RELAY_POOL_SIZE, sizeof(uint8_t));
+    builtQueue = xQueueCreate(RELAY_POOL_SIZE, sizeof(uint8_t));
+    displayQueue = xQueueCreate(1, sizeof(DisplayMsg));
+    Log.buffered = true;
+    Log.muted = SNIFFER_MODE;
+
+    // all handles are set before any task runs
+    vTaskSuspendAll();
+    for (uint8_t i = 0; i < TASK_COUNT; i++)
+        xTaskCreate(tasks[i].fn, tasks[i].name, tasks[i].stackWords, NULL,
+                    tasks[i].priority, &tasks[i].handle);
+    radioTaskHandle = tasks[TASK_RADIO].handle;
+    Log.reader = tasks[TASK_LOG].handle;
+    taskReportMillis = displayOnSince = millis();
+    xTaskResumeAll();
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Switch USB off when VBUS has been up USB_IDLE_OFF_MS with no host
+//   A charger or power bank never enumerates the CDC port, yet the
+//   USB peripheral stays enabled and keeps the HFXO running. It is
+//   torn down the way TinyUSB handles a cable pull, and the next
+//   plug-in brings it back. A host that enumerated and then suspended
+//   the bus is left alone: TinyUSB already puts the controller in low
+//   power mode then. Runs with each task report
+// ─────────────────────────────────────────────────────────────────
+extern "C" bool tud_mounted(void);
+extern "C" void tusb_hal_nrf_power_event(uint32_t event);
+#define USB_EVT_REMOVED  1          // as NRFX_POWER_USB_EVT_REMOVED
+
+static uint32_t usbIdleSince = 0;
+
+static void usbIdleCheck()
+{
+    uint32_t now = millis();
+    if (!USB_IDLE_OFF_MS || !NRF_USBD->ENABLE || tud_mounted()) {
+        usbIdleSince = now;
+        return;
+    }
+    if (now - usbIdleSince < USB_IDLE_OFF_MS) return;
+    tusb_hal_nrf_power_event(USB_EVT_REMOVED);
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Add a report interval to the charge estimate
+//   The MCU is taken as awake for `awakeUs` and asleep otherwise; the
+//   SX1262 as in RX at the current gain mode except for uplink airtime
+// ─────────────────────────────────────────────────────────────────
+static void powerAccount(uint32_t elapsedUs, uint32_t awakeUs)
+{
+    if (awakeUs > elapsedUs) awakeUs = elapsedUs;
+    uint32_t txUs = radioTxUs - powerLastTxUs;
+    powerLastTxUs = radioTxUs;
+    if (txUs > elapsedUs) txUs = elapsedUs;
+
+    uint32_t oledMs = displayOnMs + (displayOn ? millis() - displayOnSince : 0);
+    uint32_t oledUs = (oledMs - powerLastOledMs) * 1000;
+    powerLastOledMs = oledMs;
+    if (oledUs > elapsedUs) oledUs = elapsedUs;
+
+    powerAwakeMs += awakeUs / 1000;
+    powerSleepMs += (elapsedUs - awakeUs) / 1000;
+    powerCharge += (uint64_t)awakeUs * POWER_MCU_ACTIVE_UA +
+                   (uint64_t)(elapsedUs - awakeUs) * POWER_MCU_SLEEP_UA +
+                   (uint64_t)txUs * POWER_TX_UA +
+                   (uint64_t)(elapsedUs - txUs) * (rxBoosted ? POWER_RX_BOOST_UA : POWER_RX_UA) +
+                   (uint64_t)oledUs * POWER_OLED_UA;
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Print per-task CPU usage since the last report, the least stack
+// each task has had free, and the charge estimate
+// ─────────────────────────────────────────────────────────────────
+static void printTaskStats()
+{
+    uint32_t now = millis();
+    uint32_t elapsedUs = (now - taskReportMillis) * 1000;
+    taskReportMillis = now;
+    if (!elapsedUs) return;
+
+    uint32_t busy[TASK_COUNT];
+    uint32_t awakeUs = 0;
+    for (uint8_t i = 0; i < TASK_COUNT; i++) {
+        busy[i] = tasks[i].busyUs - tasks[i].lastBusyUs;
+        tasks[i].lastBusyUs = tasks[i].busyUs;
+        awakeUs += busy[i];
+    }
+    powerAccount(elapsedUs, awakeUs);
+    if (!Serial) return;
+
+    for (uint8_t i = 0; i < TASK_COUNT; i++) {
+        TaskSlot &t = tasks[i];
+        Log.print(F("[Tasks] "));
+        Log.print(t.name);
+        Log.print(F(": CPU "));
+        Log.print(100.0f * busy[i] / elapsedUs, 2);
+        Log.print(F("%, stack free "));
+        Log.print((uint32_t)uxTaskGetStackHighWaterMark(t.handle) * sizeof(StackType_t));
+        Log.print(F(" of "));
+        Log.print((uint32_t)t.stackWords * sizeof(StackType_t));
+        Log.println(F(" B"));
+    }
+    Log.print(F("[Tasks] Log dropped "));
+    Log.print(Log.dropped);
+    Log.print(F(" B, RX lost to a busy pool "));
+    Log.println(rxOverruns);
+
+    uint32_t relayed = 0;
+    for (uint8_t q = 0; q < TXQ_COUNT; q++) relayed += txQueues[q].sent;
+    float uAh = powerCharge / 3.6e9f;
+    Log.print(F("[Power] Awake "));
+    Log.print(powerAwakeMs);
+    Log.print(F(" ms, asleep "));
+    Log.print(powerSleepMs);
+    Log.print(F(" ms, TX "));
+    Log.print(radioTxUs / 1000);
+    Log.print(F(" ms, OLED "));
+    Log.print(displayOn ? F("on") : F("off"));
+    Log.print(F("; about "));
+    Log.print(uAh, 1);
+    Log.print(F(" uAh since boot"));
+    if (relayed) {
+        Log.print(F(", "));
+        Log.print(uAh / relayed, 2);
+        Log.print(F(" uAh per relayed frame"));
+    }
+    Log.println();
+}
+
+// ─────────────────────────────────────────────────────────────────
+// Runs in the core's loop task once the relay tasks are up; only
+// reports on them
+// ─────────────────────────────────────────────────────────────────
+void loop()
+{
+    if (SURVEY_MODE) {
+        surveySweep();
+        return;
+    }
+
+    delay(TASK_REPORT_MS);
+    printTaskStats();
+    printMemoryStats();
+    usbIdleCheck();
 }
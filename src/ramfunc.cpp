@@ -0,0 +1,17 @@
+#include <string.h>
+#include <stdint.h>
+#include "ramfunc.h"
+
+// Bounds of .ramfunc in RAM and of its image in flash, from the
+// linker script
+extern uint32_t __ramfunc_start__[];
+extern uint32_t __ramfunc_end__[];
+extern uint32_t __ramfunc_load__[];
+
+// The startup code only copies .data; this runs first among the
+// constructors, none of which call RAMFUNC code
+__attribute__((constructor(101))) static void ramfuncCopy()
+{
+    memcpy(__ramfunc_start__, __ramfunc_load__,
+           (size_t)(__ramfunc_end__ - __ramfunc_start__) * sizeof(uint32_t));
+}
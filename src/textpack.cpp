@@ -0,0 +1,86 @@
+#include <RadioLib.h>
+#include "textpack.h"
+
+// Symbols 0-94 are ' '..'~', then '\n' and the escape for raw bytes
+#define TP_SYMBOLS   97
+#define TP_NEWLINE   95
+#define TP_ESC       96
+#define TP_MAX_BITS  13
+
+// Code length of each symbol. Keep in sync with TEXTPACK_LENGTHS in
+// textpack.py; the escape must stay the longest code so that the 1-bit
+// padding is a prefix of it and never decodes
+static constexpr uint8_t tpLen[TP_SYMBOLS] = {
+     3, 10, 10, 11, 13, 11, 12,  9, 11, 11, 12, 11,  7,  9,  7, 10,
+     8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  9, 12, 12, 11, 12, 10,
+    12,  7, 10,  9,  8,  7,  9,  9,  8,  8, 11, 11,  8,  9,  8,  7,
+    10, 11,  8,  8,  7,  9, 10,  9, 11,  9, 11, 12, 12, 12, 12, 10,
+    12,  4,  6,  6,  5,  4,  6,  6,  5,  4, 10,  7,  5,  6,  4,  4,
+     6, 10,  5,  4,  4,  6,  7,  6,  9,  6, 11, 12, 12, 12, 12,  9,
+    13,
+};
+
+// Canonical codes are handed out in (length, symbol) order, so the
+// code of `s` is the share of the code space taken by the symbols
+// before it, scaled to its own length
+struct TpCodes {
+    uint16_t c[TP_SYMBOLS];
+};
+
+static constexpr bool tpBefore(size_t t, size_t s)
+{
+    return tpLen[t] < tpLen[s] || (tpLen[t] == tpLen[s] && t < s);
+}
+
+static constexpr uint32_t tpSpan(size_t s, size_t t = 0)
+{
+    return t == TP_SYMBOLS ? 0 :
+           (tpBefore(t, s) ? (uint32_t)1 << (TP_MAX_BITS - tpLen[t]) : 0) + tpSpan(s, t + 1);
+}
+
+template<size_t... I>
+static constexpr TpCodes tpGenerate(RadioLibIndexSeq<I...>)
+{
+    return TpCodes{{ (uint16_t)(tpSpan(I) >> (TP_MAX_BITS - tpLen[I]))... }};
+}
+
+static constexpr TpCodes tpCodes = tpGenerate(RadioLibMakeIndexSeq<TP_SYMBOLS>::type());
+
+static_assert(tpCodes.c[TP_ESC] == (1 << TP_MAX_BITS) - 1, "escape must be the all-ones code");
+
+uint8_t textPackCode(uint8_t b, uint32_t *code)
+{
+    uint8_t sym = (b >= 0x20 && b <= 0x7E) ? b - 0x20 :
+                  (b == '\n') ? TP_NEWLINE : TP_ESC;
+    *code = tpCodes.c[sym];
+    if (sym != TP_ESC) return tpLen[sym];
+    *code = (*code << 8) | b;
+    return tpLen[sym] + 8;
+}
+
+size_t textPack(const uint8_t *in, size_t len, uint8_t *out, size_t outMax)
+{
+    uint32_t acc = 0;       // pending bits, right-aligned
+    uint8_t  bits = 0;
+    size_t   pos = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        uint32_t code;
+        uint8_t n = textPackCode(in[i], &code);
+        acc = (acc << n) | code;
+        bits += n;
+
+        // at most 7 + 13 + 8 bits pending, flush whole bytes
+        while (bits >= 8) {
+            if (pos == outMax) return 0;
+            bits -= 8;
+            out[pos++] = (uint8_t)(acc >> bits);
+        }
+    }
+
+    if (bits) {
+        if (pos == outMax) return 0;
+        out[pos++] = (uint8_t)((acc << (8 - bits)) | (0xFF >> bits));
+    }
+    return pos;
+}
@@ -0,0 +1,20 @@
+#ifndef _TEST_HEX_H_
+#define _TEST_HEX_H_
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Known answers are written as hex strings, as in the specs they come from
+static inline size_t unhex(const char *hex, uint8_t *out)
+{
+    size_t n = 0;
+    for (; hex[0] && hex[1]; hex += 2) {
+        unsigned b;
+        sscanf(hex, "%2x", &b);
+        out[n++] = (uint8_t)b;
+    }
+    return n;
+}
+
+#endif // _TEST_HEX_H_
@@ -0,0 +1,89 @@
+// Compile-time time-on-air tables (include/airtime.h) against
+// SX126x::calculateTimeOnAir(), for every payload length of every
+// profile the relay uses
+
+#include <unity.h>
+#include <RadioLib.h>
+#include "airtime.h"
+
+// calculateTimeOnAir() is pure arithmetic; the radio only needs a HAL
+// to be constructed
+class NullHal : public RadioLibHal {
+public:
+    NullHal() : RadioLibHal(0, 1, 0, 1, 1, 2) {}
+    void pinMode(uint32_t, uint32_t) override {}
+    void digitalWrite(uint32_t, uint32_t) override {}
+    uint32_t digitalRead(uint32_t) override { return 0; }
+    void attachInterrupt(uint32_t, void (*)(void), uint32_t) override {}
+    void detachInterrupt(uint32_t) override {}
+    void delay(RadioLibTime_t) override {}
+    void delayMicroseconds(RadioLibTime_t) override {}
+    RadioLibTime_t millis() override { return 0; }
+    RadioLibTime_t micros() override { return 0; }
+    long pulseIn(uint32_t, uint32_t, RadioLibTime_t) override { return 0; }
+    void spiBegin() override {}
+    void spiBeginTransaction() override {}
+    void spiTransfer(uint8_t *, size_t, uint8_t *) override {}
+    void spiEndTransaction() override {}
+    void spiEnd() override {}
+};
+
+static NullHal hal;
+static Module module(&hal, RADIOLIB_NC, RADIOLIB_NC, RADIOLIB_NC);
+static SX1262 radio(&module);
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Past the table the tables fall back to the same formula; a few
+// lengths beyond it check that path too
+template<uint8_t SF, uint16_t BwKhz, uint8_t CR, uint16_t Preamble, bool Crc>
+static void matchRuntime()
+{
+    typedef LoRaToa<SF, BwKhz, CR, Preamble, Crc> Toa;
+
+    DataRate_t dr = {};
+    dr.lora.spreadingFactor = SF;
+    dr.lora.bandwidth = BwKhz;
+    dr.lora.codingRate = CR;
+    PacketConfig_t pc = {};
+    pc.lora.preambleLength = Preamble;
+    pc.lora.crcEnabled = Crc;
+    pc.lora.implicitHeader = false;
+    // as SX126x::setModulationParams() decides it: symbols of 16 ms and up
+    pc.lora.ldrOptimize = (float)(1 << SF) / BwKhz >= 16.0f;
+    TEST_ASSERT_EQUAL(pc.lora.ldrOptimize, Toa::Ldro);
+
+    for (size_t len = 0; len <= RADIOLIB_SX126X_MAX_PACKET_LENGTH + 8; len++) {
+        uint32_t want = (uint32_t)radio.calculateTimeOnAir(RADIOLIB_MODEM_LORA, dr, pc, len);
+        TEST_ASSERT_EQUAL_UINT32(want, Toa::us(len));
+    }
+}
+
+static void test_relay_profiles(void)
+{
+    matchRuntime<7, 500, 5, 8, true>();     // ToaTempest
+    matchRuntime<7, 125, 5, 8, true>();     // ToaLoRaWAN
+    matchRuntime<8, 500, 5, 8, true>();     // ToaLoRaWANDr4
+}
+
+static void test_meshtastic_presets(void)
+{
+    // meshPresets[] in main.cpp: 16 symbol preamble, CRC off
+    matchRuntime<7,  500, 5, 16, false>();  // ShortTurbo
+    matchRuntime<7,  250, 5, 16, false>();  // ShortFast
+    matchRuntime<8,  250, 5, 16, false>();  // ShortSlow
+    matchRuntime<9,  250, 5, 16, false>();  // MediumFast
+    matchRuntime<10, 250, 5, 16, false>();  // MediumSlow
+    matchRuntime<11, 250, 5, 16, false>();  // LongFast
+    matchRuntime<11, 125, 8, 16, false>();  // LongMod
+    matchRuntime<12, 125, 8, 16, false>();  // LongSlow
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_relay_profiles);
+    RUN_TEST(test_meshtastic_presets);
+    return UNITY_END();
+}
@@ -0,0 +1,88 @@
+// Table-driven RadioLibCRCTable against the bitwise RadioLibCRC, in
+// whichever mode RADIOLIB_CRC_SLICE_BY_4 / RADIOLIB_CRC_BITWISE select
+// (env:native, env:native_crc_slice4, env:native_crc_bitwise)
+
+#include <unity.h>
+#include <RadioLib.h>
+
+static uint8_t buf[300];
+
+void setUp(void)
+{
+    // fixed pseudo-random input, so failures reproduce
+    uint32_t x = 0x12345678;
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        x = x * 1103515245 + 12345;
+        buf[i] = (uint8_t)(x >> 16);
+    }
+}
+
+void tearDown(void) {}
+
+// Every length up to 67 covers each tail after the 4-byte steps, then
+// a few long buffers at odd offsets
+template<uint8_t Size, uint32_t Poly, uint32_t Init, uint32_t Out, bool RefIn, bool RefOut>
+static void matchBitwise()
+{
+    RadioLibCRC ref;
+    ref.size = Size;
+    ref.poly = Poly;
+    ref.init = Init;
+    ref.out = Out;
+    ref.refIn = RefIn;
+    ref.refOut = RefOut;
+
+    typedef RadioLibCRCTable<Size, Poly, Init, Out, RefIn, RefOut> Crc;
+    for (size_t len = 0; len < 68; len++)
+        TEST_ASSERT_EQUAL_HEX32(ref.checksum(buf, len), Crc::checksum(buf, len));
+    for (size_t off = 0; off < 4; off++)
+        TEST_ASSERT_EQUAL_HEX32(ref.checksum(&buf[off], 255), Crc::checksum(&buf[off], 255));
+}
+
+static void test_lrfhss(void)
+{
+    matchBitwise<16, 0x755B, 0xFFFF, 0x0000, false, false>();   // payload
+    matchBitwise<8, 0x2F, 0xFF, 0x00, false, false>();          // header
+}
+
+static void test_ax25_fcs(void)
+{
+    matchBitwise<16, RADIOLIB_CRC_CCITT_POLY, RADIOLIB_CRC_CCITT_INIT, RADIOLIB_CRC_CCITT_OUT, false, false>();
+}
+
+static void test_reflected(void)
+{
+    matchBitwise<32, 0x04C11DB7, 0xFFFFFFFF, 0xFFFFFFFF, true, true>();
+    matchBitwise<16, 0x1021, 0x0000, 0x0000, true, true>();
+    matchBitwise<16, 0x8005, 0x0000, 0x1234, true, false>();
+    matchBitwise<12, 0x80F, 0x000, 0x000, false, true>();
+}
+
+static void test_odd_sizes(void)
+{
+    matchBitwise<24, 0x864CFB, 0xB704CE, 0x000000, false, false>();
+    matchBitwise<12, 0x80F, 0xABC, 0x123, false, false>();
+    matchBitwise<9, 0x119, 0x1FF, 0x000, true, true>();
+}
+
+static void test_check_values(void)
+{
+    // CRC catalogue check values over "123456789"
+    const uint8_t *check = (const uint8_t *)"123456789";
+    TEST_ASSERT_EQUAL_HEX32(0x29B1, (RadioLibCRCTable<16, 0x1021, 0xFFFF, 0x0000>::checksum(check, 9)));
+    TEST_ASSERT_EQUAL_HEX32(0x2189, (RadioLibCRCTable<16, 0x1021, 0x0000, 0x0000, true, true>::checksum(check, 9)));
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, (RadioLibCRCTable<32, 0x04C11DB7, 0xFFFFFFFF, 0xFFFFFFFF, true, true>::checksum(check, 9)));
+    TEST_ASSERT_EQUAL_HEX32(0x21CF02, (RadioLibCRCTable<24, 0x864CFB, 0xB704CE, 0x000000>::checksum(check, 9)));
+    TEST_ASSERT_EQUAL_HEX32(0xDAF, (RadioLibCRCTable<12, 0x80F, 0x000, 0x000, false, true>::checksum(check, 9)));
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_lrfhss);
+    RUN_TEST(test_ax25_fcs);
+    RUN_TEST(test_reflected);
+    RUN_TEST(test_odd_sizes);
+    RUN_TEST(test_check_values);
+    return UNITY_END();
+}
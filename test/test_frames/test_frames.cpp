@@ -0,0 +1,88 @@
+// Meshtastic Data protobuf and LoRaWAN uplink framing (src/frames.cpp)
+
+#include <unity.h>
+#include <string.h>
+#include "crypto.h"
+#include "frames.h"
+#include "../hex.h"
+
+static const char *text = "Hello from TEMPEST";
+static uint8_t buf[LW_B0_LEN + 255 + 13];
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_data_protobuf(void)
+{
+    uint8_t want[32];
+    size_t n = encodeDataProtobuf(buf, 1, (const uint8_t *)text, strlen(text));
+    TEST_ASSERT_EQUAL_size_t(unhex("0801121248656c6c6f2066726f6d2054454d50455354", want), n);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(want, buf, n);
+
+    n = encodeDataProtobuf(buf, 256, (const uint8_t *)"", 0);
+    TEST_ASSERT_EQUAL_size_t(unhex("0880021200", want), n);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(want, buf, n);
+}
+
+static void test_data_protobuf_long_payload(void)
+{
+    // lengths from 128 up take a 2-byte varint
+    static uint8_t payload[200];
+    uint8_t want[5];
+    unhex("080112c801", want);
+    size_t n = encodeDataProtobuf(buf, 1, payload, sizeof(payload));
+    TEST_ASSERT_EQUAL_size_t(sizeof(want) + sizeof(payload), n);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(want, buf, sizeof(want));
+}
+
+static void test_uplink_known_answer(void)
+{
+    static const uint8_t zeroKey[16] = {};
+    if (memcmp(nwkSKey, zeroKey, 16) || memcmp(appSKey, zeroKey, 16) ||
+        LORAWAN_PACK_PAYLOAD || LORAWAN_RX_STAMP)
+        TEST_IGNORE_MESSAGE("boards.h is not at its defaults");
+
+    uint8_t want[64];
+    uint16_t saved;
+    size_t n = buildLoRaWANUplink(buf, (const uint8_t *)text, strlen(text),
+                                  0x260B1234, 7, false, 0, &saved);
+    TEST_ASSERT_EQUAL_size_t(unhex("4034120b2600070001e63faa29aa562ea8a95b71bfe8bd2f4c83db3fcda571", want), n);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(want, &buf[LW_B0_LEN], n);
+    TEST_ASSERT_EQUAL_UINT(0, saved);
+}
+
+static void test_uplink_link_check(void)
+{
+    if (LORAWAN_PACK_PAYLOAD || LORAWAN_RX_STAMP)
+        TEST_IGNORE_MESSAGE("boards.h is not at its defaults");
+
+    uint16_t saved;
+    size_t len = strlen(text);
+    size_t n = buildLoRaWANUplink(buf, (const uint8_t *)text, len,
+                                  0x260B1234, 0x1234, true, 0, &saved);
+    uint8_t *frame = &buf[LW_B0_LEN];
+    TEST_ASSERT_EQUAL_size_t(9 + 1 + len + 4, n);
+    TEST_ASSERT_EQUAL_HEX8(0x01, frame[5]);         // FOptsLen
+    TEST_ASSERT_EQUAL_HEX8(0x34, frame[6]);         // FCnt, LE
+    TEST_ASSERT_EQUAL_HEX8(0x12, frame[7]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, frame[8]);         // LinkCheckReq
+    TEST_ASSERT_EQUAL_HEX8(0x01, frame[9]);         // FPort
+
+    // the MIC covers the whole frame before it
+    uint8_t mic[4];
+    lorawanMic(buf, n - 4, 0, 0x260B1234, 0x1234, mic);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(mic, &frame[n - 4], 4);
+
+    aes128ctr_lorawan(appSKey, 0, 0x260B1234, 0x1234, &frame[10], len);
+    TEST_ASSERT_EQUAL_MEMORY(text, &frame[10], len);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_data_protobuf);
+    RUN_TEST(test_data_protobuf_long_payload);
+    RUN_TEST(test_uplink_known_answer);
+    RUN_TEST(test_uplink_link_check);
+    return UNITY_END();
+}
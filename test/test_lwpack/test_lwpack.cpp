@@ -0,0 +1,58 @@
+// LZ77 payload packing over the static dictionary (src/lwpack.cpp).
+// The expected bytes decode back to the input with lwpack.py
+
+#include <unity.h>
+#include <string.h>
+#include "lwpack.h"
+#include "../hex.h"
+
+static const struct {
+    const char *text;
+    const char *packed;
+} known[] = {
+    { "Hello from TEMPEST",                     "f7cf4d2c821477f6fe1fc7b7e9df" },
+    { "sensor 3 reports water level 1.25 m\n",  "30238db5c5e0a29f2f5f9bd31c3f5f" },
+    { "\x01\xff" "ab",                          "fffc07fffff96c" },
+    { "the relay is ok, uptime 12 minutes",     "2168438f2f98ea5f" },
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_known_answers(void)
+{
+    uint8_t out[256], want[64];
+    for (const auto &k : known) {
+        size_t n = lwPack((const uint8_t *)k.text, strlen(k.text), out, sizeof(out));
+        TEST_ASSERT_EQUAL_size_t(unhex(k.packed, want), n);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(want, out, n);
+    }
+}
+
+static void test_out_max(void)
+{
+    uint8_t out[64];
+    const char *t = known[3].text;
+    memset(out, 0xAA, sizeof(out));
+    TEST_ASSERT_EQUAL_size_t(0, lwPack((const uint8_t *)t, strlen(t), out, 7));
+    TEST_ASSERT_EQUAL_HEX8(0xAA, out[7]);
+    TEST_ASSERT_EQUAL_size_t(8, lwPack((const uint8_t *)t, strlen(t), out, 8));
+}
+
+static void test_max_len(void)
+{
+    // a whole window of input back-references itself
+    static uint8_t in[LWPACK_MAX_LEN], out[LWPACK_MAX_LEN];
+    memset(in, 'a', sizeof(in));
+    size_t n = lwPack(in, sizeof(in), out, sizeof(out));
+    TEST_ASSERT_TRUE(n > 0 && n < 40);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_known_answers);
+    RUN_TEST(test_out_max);
+    RUN_TEST(test_max_len);
+    return UNITY_END();
+}
@@ -0,0 +1,64 @@
+// Static-Huffman text packing (src/textpack.cpp). The expected bytes
+// decode back to the input with textpack.py
+
+#include <unity.h>
+#include <string.h>
+#include "textpack.h"
+#include "../hex.h"
+
+static const struct {
+    const char *text;
+    const char *packed;
+} known[] = {
+    { "Hello from TEMPEST",                     "ef3a5185d56c06fdbf0fc76fa6ff" },
+    { "sensor 3 reports water level 1.25 m\n",  "73576a8e7153c5ab0e33283a8a1f13a0e5d7cdd230faff" },
+    { "\x01\xff" "ab",                          "fff80fffffcacf" },
+    { "the relay is ok, uptime 12 minutes",     "8998a9d0b408e1b86a196309818e5e61822e506f" },
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_known_answers(void)
+{
+    uint8_t out[256], want[64];
+    for (const auto &k : known) {
+        size_t n = textPack((const uint8_t *)k.text, strlen(k.text), out, sizeof(out));
+        TEST_ASSERT_EQUAL_size_t(unhex(k.packed, want), n);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(want, out, n);
+    }
+}
+
+static void test_out_max(void)
+{
+    // gives up rather than write past outMax
+    uint8_t out[64];
+    const char *t = known[0].text;
+    memset(out, 0xAA, sizeof(out));
+    TEST_ASSERT_EQUAL_size_t(0, textPack((const uint8_t *)t, strlen(t), out, 13));
+    TEST_ASSERT_EQUAL_HEX8(0xAA, out[13]);
+    TEST_ASSERT_EQUAL_size_t(14, textPack((const uint8_t *)t, strlen(t), out, 14));
+}
+
+static void test_codes(void)
+{
+    uint32_t code;
+    TEST_ASSERT_EQUAL_UINT8(3, textPackCode(' ', &code));
+    TEST_ASSERT_EQUAL_HEX32(0, code);
+
+    // escape: the all-ones 13-bit code, then the raw byte
+    TEST_ASSERT_EQUAL_UINT8(21, textPackCode(0x01, &code));
+    TEST_ASSERT_EQUAL_HEX32((0x1FFF << 8) | 0x01, code);
+
+    for (unsigned b = 0; b < 256; b++)
+        TEST_ASSERT_TRUE(textPackCode((uint8_t)b, &code) <= 21);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_known_answers);
+    RUN_TEST(test_out_max);
+    RUN_TEST(test_codes);
+    return UNITY_END();
+}
@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+"""Decoder for text packed by src/textpack.cpp (static canonical Huffman)."""
+
+TEXTPACK_PORTNUM = 256
+
+# code length of ' '..'~', '\n', escape; must match tpLen in textpack.cpp
+TEXTPACK_LENGTHS = [
+     3, 10, 10, 11, 13, 11, 12,  9, 11, 11, 12, 11,  7,  9,  7, 10,
+     8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  9, 12, 12, 11, 12, 10,
+    12,  7, 10,  9,  8,  7,  9,  9,  8,  8, 11, 11,  8,  9,  8,  7,
+    10, 11,  8,  8,  7,  9, 10,  9, 11,  9, 11, 12, 12, 12, 12, 10,
+    12,  4,  6,  6,  5,  4,  6,  6,  5,  4, 10,  7,  5,  6,  4,  4,
+     6, 10,  5,  4,  4,  6,  7,  6,  9,  6, 11, 12, 12, 12, 12,  9,
+    13,
+]
+
+def _textpack_codes():
+    """Canonical Huffman codes, handed out in (length, symbol) order."""
+    codes, code, prev = {}, 0, 0
+    for sym in sorted(range(len(TEXTPACK_LENGTHS)), key=lambda s: (TEXTPACK_LENGTHS[s], s)):
+        n = TEXTPACK_LENGTHS[sym]
+        code <<= n - prev
+        codes[(n, code)] = sym
+        code += 1; prev = n
+    return codes
+
+TEXTPACK_CODES = _textpack_codes()
+
+def textpack_unpack(buf):
+    """Decode a packed payload; trailing 1-bit padding never completes a code."""
+    out = bytearray()
+    bits = "".join(f"{b:08b}" for b in buf)
+    i = 0
+    while True:
+        b, i = textpack_read_symbol(bits, i)
+        if b is None:
+            return bytes(out)
+        out.append(b)
+
+def textpack_read_symbol(bits, i):
+    """Decode one byte starting at bit `i` of a '0'/'1' string.
+
+    Returns (byte, next_i), or (None, i) if the bits run out first.
+    """
+    n, code = 0, 0
+    while i < len(bits):
+        code = (code << 1) | (bits[i] == "1"); n += 1; i += 1
+        sym = TEXTPACK_CODES.get((n, code))
+        if sym is None:
+            continue
+        if sym == 96:           # escape: raw byte follows
+            if i + 8 > len(bits):
+                return None, i
+            return int(bits[i : i + 8], 2), i + 8
+        return (0x0A if sym == 95 else 0x20 + sym), i
+    return None, i
+
+if __name__ == "__main__":
+    import sys
+    for arg in sys.argv[1:]:
+        print(textpack_unpack(bytes.fromhex(arg)).decode("utf-8", errors="replace"))